@@ -10,11 +10,15 @@
 
 #define ADOCPP_VERSION "0.0.1"
 
+#include "AdoCpp/BinaryJson.h"
 #include "AdoCpp/Color.h"
 #include "AdoCpp/Easing.h"
 #include "AdoCpp/Event.h"
 #include "AdoCpp/Level.h"
 #include "AdoCpp/Camera.h"
+#include "AdoCpp/Generator.h"
+#include "AdoCpp/ParseStats.h"
+#include "AdoCpp/StringPool.h"
 #include "AdoCpp/Utils.h"
 
 /**
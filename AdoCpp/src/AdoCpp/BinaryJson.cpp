@@ -0,0 +1,285 @@
+#include "BinaryJson.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace AdoCpp::BinaryJson
+{
+    namespace
+    {
+        enum Type : uint8_t
+        {
+            Null,
+            False,
+            True,
+            Int,
+            UInt,
+            Real,
+            String,
+            Array,
+            Object
+        };
+
+        class Writer
+        {
+        public:
+            explicit Writer(std::streambuf& buf) : m_buf(buf) {}
+
+            /**
+             * Whether the buffer has refused a write. Nothing more is written after that.
+             */
+            [[nodiscard]] bool failed() const { return m_failed; }
+
+            void byte(const uint8_t b)
+            {
+                if (!m_failed && m_buf.sputc(static_cast<char>(b)) == std::char_traits<char>::eof())
+                    m_failed = true;
+            }
+            void varint(uint64_t v)
+            {
+                for (; v >= 0x80; v >>= 7)
+                    byte(static_cast<uint8_t>(v | 0x80));
+                byte(static_cast<uint8_t>(v));
+            }
+            void string(const char* begin, const char* end)
+            {
+                varint(static_cast<uint64_t>(end - begin));
+                if (!m_failed && m_buf.sputn(begin, end - begin) != end - begin)
+                    m_failed = true;
+            }
+            void value(const Json::Value& value)
+            {
+                if (m_failed)
+                    return;
+                switch (value.type())
+                {
+                case Json::nullValue:
+                    byte(Null);
+                    break;
+                case Json::booleanValue:
+                    byte(value.asBool() ? True : False);
+                    break;
+                case Json::intValue:
+                    {
+                        const int64_t v = value.asInt64();
+                        byte(Int), varint(static_cast<uint64_t>(v) << 1 ^ static_cast<uint64_t>(v >> 63));
+                        break;
+                    }
+                case Json::uintValue:
+                    byte(UInt), varint(value.asUInt64());
+                    break;
+                case Json::realValue:
+                    {
+                        const auto bits = std::bit_cast<uint64_t>(value.asDouble());
+                        byte(Real);
+                        for (int i = 0; i < 64; i += 8)
+                            byte(static_cast<uint8_t>(bits >> i));
+                        break;
+                    }
+                case Json::stringValue:
+                    {
+                        const char *begin, *end;
+                        value.getString(&begin, &end);
+                        byte(String), string(begin, end);
+                        break;
+                    }
+                case Json::arrayValue:
+                    byte(Array), varint(value.size());
+                    for (const auto& element : value)
+                        this->value(element);
+                    break;
+                case Json::objectValue:
+                    byte(Object), varint(value.size());
+                    for (auto it = value.begin(); it != value.end(); ++it)
+                    {
+                        const char* end;
+                        const char* begin = it.memberName(&end);
+                        string(begin, end);
+                        this->value(*it);
+                    }
+                    break;
+                }
+            }
+
+        private:
+            std::streambuf& m_buf;
+            bool m_failed = false;
+        };
+
+        class Reader
+        {
+        public:
+            Reader(std::streambuf& buf, std::string* err) : m_buf(buf), m_err(err) {}
+
+            bool fail(const char* what)
+            {
+                if (m_err)
+                    *m_err = what;
+                return false;
+            }
+            bool byte(uint8_t& b)
+            {
+                const auto c = m_buf.sbumpc();
+                if (c == std::char_traits<char>::eof())
+                    return fail("Unexpected end of the binary json data");
+                b = static_cast<uint8_t>(c);
+                return true;
+            }
+            bool varint(uint64_t& v)
+            {
+                v = 0;
+                for (int shift = 0; shift < 64; shift += 7)
+                {
+                    uint8_t b;
+                    if (!byte(b))
+                        return false;
+                    v |= static_cast<uint64_t>(b & 0x7f) << shift;
+                    if (!(b & 0x80))
+                        return true;
+                }
+                return fail("Invalid varint in the binary json data");
+            }
+            bool string(std::string& str)
+            {
+                uint64_t length;
+                if (!varint(length))
+                    return false;
+                // Read in chunks, so that a corrupted length cannot allocate more than the data holds.
+                str.clear();
+                char chunk[4096];
+                while (length > 0)
+                {
+                    const auto n = static_cast<std::streamsize>(std::min<uint64_t>(length, sizeof(chunk)));
+                    if (m_buf.sgetn(chunk, n) != n)
+                        return fail("Unexpected end of the binary json data");
+                    str.append(chunk, static_cast<size_t>(n)), length -= static_cast<uint64_t>(n);
+                }
+                return true;
+            }
+            bool value(Json::Value& value, const int depth)
+            {
+                if (depth < 0)
+                    return fail("The binary json data is nested too deeply");
+                uint8_t type;
+                if (!byte(type))
+                    return false;
+                switch (type)
+                {
+                case Null:
+                    value = Json::Value();
+                    return true;
+                case False:
+                case True:
+                    value = type == True;
+                    return true;
+                case Int:
+                    {
+                        uint64_t v;
+                        if (!varint(v))
+                            return false;
+                        value = Json::Int64(static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1));
+                        return true;
+                    }
+                case UInt:
+                    {
+                        uint64_t v;
+                        if (!varint(v))
+                            return false;
+                        value = Json::UInt64(v);
+                        return true;
+                    }
+                case Real:
+                    {
+                        uint64_t bits = 0;
+                        for (int i = 0; i < 64; i += 8)
+                        {
+                            uint8_t b;
+                            if (!byte(b))
+                                return false;
+                            bits |= static_cast<uint64_t>(b) << i;
+                        }
+                        value = std::bit_cast<double>(bits);
+                        return true;
+                    }
+                case String:
+                    {
+                        std::string str;
+                        if (!string(str))
+                            return false;
+                        value = Json::Value(str);
+                        return true;
+                    }
+                case Array:
+                    {
+                        uint64_t count;
+                        if (!varint(count))
+                            return false;
+                        value = Json::Value(Json::arrayValue);
+                        for (uint64_t i = 0; i < count; i++)
+                            if (!this->value(value.append(Json::Value()), depth - 1))
+                                return false;
+                        return true;
+                    }
+                case Object:
+                    {
+                        uint64_t count;
+                        if (!varint(count))
+                            return false;
+                        value = Json::Value(Json::objectValue);
+                        std::string key;
+                        for (uint64_t i = 0; i < count; i++)
+                            if (!string(key) || !this->value(value[key], depth - 1))
+                                return false;
+                        return true;
+                    }
+                default:
+                    return fail("Invalid type in the binary json data");
+                }
+            }
+
+        private:
+            std::streambuf& m_buf;
+            std::string* m_err;
+        };
+    } // namespace
+
+    bool detect(std::istream& is)
+    {
+        const auto position = is.tellg();
+        char header[sizeof(magic)]{};
+        is.read(header, sizeof(header));
+        const bool binary = is.gcount() == sizeof(header) && std::equal(header, header + sizeof(header), magic);
+        is.clear();
+        is.seekg(position);
+        return binary;
+    }
+
+    void write(std::ostream& os, const Json::Value& value)
+    {
+        if (!os.write(magic, sizeof(magic)).put(version))
+            return;
+        // The writer goes to the buffer directly, so the stream learns of a failure only from here.
+        Writer writer(*os.rdbuf());
+        writer.value(value);
+        if (writer.failed())
+            os.setstate(std::ios::badbit);
+    }
+
+    bool read(std::istream& is, Json::Value& value, std::string* err, const int maxDepth)
+    {
+        char header[sizeof(magic) + 1]{};
+        if (!is.read(header, sizeof(header)) || !std::equal(magic, magic + sizeof(magic), header))
+        {
+            if (err)
+                *err = "Not binary json data";
+            return false;
+        }
+        if (header[sizeof(magic)] != version)
+        {
+            if (err)
+                *err = "Unsupported version of binary json data";
+            return false;
+        }
+        return Reader(*is.rdbuf(), err).value(value, maxDepth);
+    }
+} // namespace AdoCpp::BinaryJson
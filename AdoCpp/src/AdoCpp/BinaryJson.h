@@ -0,0 +1,42 @@
+#pragma once
+#include <istream>
+#include <ostream>
+#include <string>
+#include <json5cpp.h>
+
+/**
+ * @brief A compact binary encoding of json data, used as a cache of levels that loads without parsing text.
+ *
+ * The data starts with the magic "ADOB" and a version byte. A value is a type byte followed by its payload:
+ * integers as (zigzag) varints, doubles as 8 little-endian bytes, strings as a varint length and the bytes, arrays
+ * as a varint count and the values, and objects as a varint count and pairs of a key string and a value.
+ */
+namespace AdoCpp::BinaryJson
+{
+    constexpr char magic[] = {'A', 'D', 'O', 'B'};
+    constexpr char version = 1;
+
+    /**
+     * @brief Check whether a stream holds binary json data, without consuming any of it.
+     * @param is The input stream.
+     * @return Whether the stream starts with the magic.
+     */
+    [[nodiscard]] bool detect(std::istream& is);
+
+    /**
+     * @brief Write json data in the binary encoding.
+     * @param os The output stream. Its badbit is set if the data could not be written entirely.
+     * @param value Json data.
+     */
+    void write(std::ostream& os, const Json::Value& value);
+
+    /**
+     * @brief Read json data in the binary encoding.
+     * @param is The input stream.
+     * @param value Receives the json data.
+     * @param err Receives the error message if not null.
+     * @param maxDepth The maximum nesting, to avoid unbounded recursion on corrupted data.
+     * @return Whether the data was read successfully.
+     */
+    bool read(std::istream& is, Json::Value& value, std::string* err = nullptr, int maxDepth = 100);
+} // namespace AdoCpp::BinaryJson
@@ -1,6 +1,8 @@
 // FIXME
 
 #include "Camera.h"
+#include <algorithm>
+#include <cassert>
 #include <ranges>
 #include <cmath>
 
@@ -15,16 +17,71 @@ namespace AdoCpp
         transition.fromX = transition.toX = position.x = settings.position.x;
         transition.fromY = transition.toY = position.y = settings.position.y;
         transition.fromRotation = transition.toRotation = rotation = settings.rotation;
-        transition.fromZoom = transition.toRotation = zoom = settings.zoom;
+        transition.fromZoom = transition.toZoom = zoom = settings.zoom;
         transition.fromPlayer = transition.toPlayer = player = double(settings.relativeTo == RelativeToCamera::Player);
-        timeline.clear();
-        timelineIndex = std::nullopt;
-        for (const auto& dynamicEvent : level.m_processedDynamicEvents)
+
+        // Process every MoveCamera at its own time once and keep the result, so update() never replays events.
+        keyframes.clear();
+        keyframes.push_back({std::numeric_limits<double>::lowest(), transition, anchorFloor});
+        for (const auto& [event, beat, seconds, floor] : level.m_processedDynamicEvents)
+        {
+            const auto moveCamera = dynamic_cast<const Event::Visual::MoveCamera*>(event.get());
+            if (!moveCamera)
+                continue;
+            processEvent(level, *moveCamera, seconds, floor);
+            keyframes.push_back({seconds, transition, anchorFloor});
+        }
+        restoreKeyframe(0);
+        lastSeconds = std::numeric_limits<double>::lowest();
+
+        followStarts.resize(level.tiles.size());
+        if (!followStarts.empty())
+            followStarts[0] = level.tiles[0].pos.o;
+        for (size_t i = 1; i < level.tiles.size(); i++)
+        {
+            const auto &lastTile = level.tiles[i - 1], &tile = level.tiles[i];
+            const double progress = std::min(1.0, (tile.beat - lastTile.beat) / 2);
+            followStarts[i] = followStarts[i - 1] + (lastTile.pos.o - followStarts[i - 1]) * progress;
+        }
+        snapPlayer = true;
+    }
+    void Camera::restoreKeyframe(const size_t index)
+    {
+        const CameraKeyframe& keyframe = keyframes[index];
+        transition = keyframe.transition, anchorFloor = keyframe.anchorFloor, keyframeIndex = index;
+        // Finished transitions rest at their targets; running ones are evaluated by update().
+        positionOffset = {transition.toX, transition.toY};
+        rotation = transition.toRotation, zoom = transition.toZoom, player = transition.toPlayer;
+    }
+    double Camera::transitionValue(const double seconds, const double fromVar, const double toVar, const State& state)
+    {
+        if (!state.active) return toVar;
+        const double t = state.durationSec == 0.0 ? 1.0 : (seconds - state.startSec) / state.durationSec;
+        return std::lerp(fromVar, toVar, ease(state.ease, std::max(0.0, std::min(1.0, t))));
+    }
+    CameraSample Camera::sample(const Level& level, const double seconds) const
+    {
+        assert(!keyframes.empty() && "AdoCpp::Camera::init must be called before sampling");
+        const auto keyframe = std::upper_bound(keyframes.begin() + 1, keyframes.end(), seconds,
+                                               [](const double t, const CameraKeyframe& k) { return t < k.seconds; });
+        const CameraKeyframe& k = *(keyframe - 1);
+        const CameraTransition& tr = k.transition;
+        const Vector2lf offset = {transitionValue(seconds, tr.fromX, tr.toX, tr.xState),
+                                  transitionValue(seconds, tr.fromY, tr.toY, tr.yState)};
+        const double follow = transitionValue(seconds, tr.fromPlayer, tr.toPlayer, tr.relativeToState);
+
+        Vector2lf playerPos, nonPlayerPos;
+        playerPos = nonPlayerPos = level.tiles[k.anchorFloor].pos.o;
+        if (relativeTo == RelativeToCamera::Player)
         {
-            const auto moveCamera = std::dynamic_pointer_cast<Event::Visual::MoveCamera>(dynamicEvent);
-            if (moveCamera)
-                timeline.push_back(*moveCamera);
+            const size_t floor = level.getFloorBySeconds(seconds);
+            const double progress =
+                std::max(0.0, std::min(1.0, (level.seconds2beat(seconds) - level.tiles[floor].beat) / 2));
+            playerPos = followStarts[floor] + (level.tiles[floor].pos.o - followStarts[floor]) * progress;
         }
+        return {playerPos * follow + nonPlayerPos * (1 - follow) + offset,
+                transitionValue(seconds, tr.fromRotation, tr.toRotation, tr.rotationState),
+                transitionValue(seconds, tr.fromZoom, tr.toZoom, tr.zoomState)};
     }
     void Camera::handleTransition(const double seconds, double& var, const double fromVar, const double toVar, State& state)
     {
@@ -38,6 +95,11 @@ namespace AdoCpp
     }
 
     void Camera::processEvent(const Level& level, const Event::Visual::MoveCamera& moveCamera, double seconds)
+    {
+        processEvent(level, moveCamera, seconds, moveCamera.floor);
+    }
+    void Camera::processEvent(const Level& level, const Event::Visual::MoveCamera& moveCamera, double seconds,
+                              size_t floor)
     {
         if (!moveCamera.active) return;
         using enum RelativeToCamera;
@@ -48,11 +110,11 @@ namespace AdoCpp
         };
 
         bool isOffset = !moveCamera.relativeTo.has_value() || moveCamera.relativeTo == LastPosition || moveCamera.relativeTo == LastPositionNoRotation;
-        double currentBPM = level.getBpmForDynamicEvent(moveCamera.floor, moveCamera.angleOffset);
+        double currentBPM = level.getBpmForDynamicEvent(floor, moveCamera.angleOffset);
         double durationSeconds = moveCamera.duration * bpm2crotchet(currentBPM);
         const State state = {
             .active = true,
-            .startSec = moveCamera.seconds,
+            .startSec = seconds,
             .durationSec = durationSeconds,
             .ease = moveCamera.ease
         };
@@ -84,7 +146,7 @@ namespace AdoCpp
             } else {
                 handleLastTransition(transition.fromPlayer, transition.toPlayer, transition.relativeToState);
                 if (moveCamera.relativeTo == Tile || moveCamera.relativeTo == Global) {
-                    anchorFloor = moveCamera.relativeTo == Global ? 0 : moveCamera.floor;
+                    anchorFloor = moveCamera.relativeTo == Global ? 0 : floor;
                     transition.toPlayer = 0;
                 } else { // Player
                     transition.toPlayer = 1;
@@ -95,36 +157,17 @@ namespace AdoCpp
     }
     void Camera::update(const Level& level, double seconds, const size_t floor)
     {
-        const double delta = std::isinf(lastSeconds) ? 0 : seconds - lastSeconds;
+        const double delta = lastSeconds == std::numeric_limits<double>::lowest() ? 0 : seconds - lastSeconds;
+        if (seconds < lastSeconds)
+            snapPlayer = true;
         lastSeconds = seconds;
 
-        // 1. Process new camera events (using high-performance Timeline)
-        // We check against timeInLevel because timeline is built using tileStartTimes (logic time)
-        if (timelineIndex) {
-            if (timelineIndex >= timeline.size()
-            || seconds < timeline[*timelineIndex].seconds) {
-                // Backward seek detected
-                init(level);
-                timelineIndex = std::nullopt;
-            }
-        }
+        // 1. Seek to the last camera keyframe at or before seconds
+        const auto keyframe = std::upper_bound(keyframes.begin() + 1, keyframes.end(), seconds,
+                                               [](const double t, const CameraKeyframe& k) { return t < k.seconds; });
+        if (const size_t index = keyframe - keyframes.begin() - 1; index != keyframeIndex)
+            restoreKeyframe(index);
 
-        if (!timelineIndex) {
-            if (!timeline.empty() && timeline[0].seconds <= seconds) {
-                timelineIndex = 0;
-                auto& entry = timeline[*timelineIndex];
-                processEvent(level, entry, seconds);
-            }
-        }
-        if (timelineIndex) {
-            while (*timelineIndex + 1 < timeline.size() && 
-                    timeline[*timelineIndex + 1].seconds <= seconds) {
-                (*timelineIndex)++;
-                auto& entry = timeline[*timelineIndex];
-                processEvent(level, entry, seconds);
-            }
-        }
-        
         // // 1.5 Process Bloom events
         // if (lastBloomTimelineIndex >= 0) {
         //     const currentEntry = bloomTimeline[lastBloomTimelineIndex];
@@ -148,7 +191,7 @@ namespace AdoCpp
         };
 
         handleTransition(positionOffset.x, transition.fromX, transition.toX, transition.xState);
-        handleTransition(positionOffset.y, transition.fromY, transition.toX, transition.yState);
+        handleTransition(positionOffset.y, transition.fromY, transition.toY, transition.yState);
         handleTransition(rotation, transition.fromRotation, transition.toRotation, transition.rotationState);
         handleTransition(zoom, transition.fromZoom, transition.toZoom, transition.zoomState);
         handleTransition(player, transition.fromPlayer, transition.toPlayer, transition.relativeToState);
@@ -160,6 +203,9 @@ namespace AdoCpp
         {
             Vector2lf currentPivotPosition = level.tiles[floor].pos.o;
             playerPos = position - positionOffset;
+            // After init or a backward seek there is no motion to continue, so start at the pivot.
+            if (snapPlayer)
+                snapPlayer = false, lastFloor = floor, lastPlayerChangedPos = playerPos = currentPivotPosition;
             // position move towards target
             if (floor != lastFloor)
                 lastFloor = floor, lastPlayerChangedPos = playerPos;
@@ -24,6 +24,26 @@ namespace AdoCpp
         State relativeToState;
     };
 
+    /**
+     * @brief The camera transition right after a MoveCamera event has been processed.
+     */
+    struct CameraKeyframe
+    {
+        double seconds;
+        CameraTransition transition;
+        size_t anchorFloor;
+    };
+
+    /**
+     * @brief What the camera shows at some time.
+     */
+    struct CameraSample
+    {
+        Vector2lf position;
+        double rotation;
+        double zoom;
+    };
+
     class Camera
     {
     public:
@@ -31,18 +51,46 @@ namespace AdoCpp
         ~Camera() = default;
         void init(const Level& level);
         void processEvent(const Level& level, const Event::Visual::MoveCamera& moveCamera, double seconds);
+        /**
+         * @brief Process a MoveCamera at the time and on the floor it takes effect, e.g. a repetition of it.
+         */
+        void processEvent(const Level& level, const Event::Visual::MoveCamera& moveCamera, double seconds,
+                          size_t floor);
         void update(const Level& level, double seconds, size_t floor);
+        /**
+         * @brief Evaluate the camera at any time, assuming the player hits every tile on time.
+         *
+         * Unlike update(), the result depends only on the level and seconds, not on earlier calls or the frame
+         * rate, so it can be called for arbitrary times and from several threads at once. init() must be called
+         * first.
+         * @param level The level passed to init().
+         * @param seconds The time in seconds.
+         * @return The camera position, rotation and zoom.
+         */
+        [[nodiscard]] CameraSample sample(const Level& level, double seconds) const;
         Vector2lf position;
         double rotation{};
         double zoom = 100;
     private:
         void handleTransition(const double seconds, double& var, const double fromVar, const double toVar, State& state);
+        void restoreKeyframe(size_t index);
+        static double transitionValue(double seconds, double fromVar, double toVar, const State& state);
         Vector2lf positionOffset;
         double lastSeconds = std::numeric_limits<double>::lowest();
-        std::vector<Event::Visual::MoveCamera> timeline;
-        std::optional<size_t> timelineIndex;
+        /**
+         * @brief keyframes[0] is the initial state and keyframes[i] the state after the first i MoveCamera events,
+         * so seeking is a binary search over the event times.
+         */
+        std::vector<CameraKeyframe> keyframes;
+        /**
+         * @brief Where the followed player is when floor i begins, for sample(). During floor i it moves linearly
+         * to the tile over two beats, which matches the speed update() uses.
+         */
+        std::vector<Vector2lf> followStarts;
+        size_t keyframeIndex{};
+        bool snapPlayer = true;
         Vector2lf lastPlayerChangedPos;
-        size_t lastFloor;
+        size_t lastFloor{};
         RelativeToCamera relativeTo;
         size_t anchorFloor;
         CameraTransition transition;
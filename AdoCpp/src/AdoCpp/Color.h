@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include <tuple>
 namespace AdoCpp
 {
     // Most of the code is copied from "SFML/Graphics/Color.hpp".
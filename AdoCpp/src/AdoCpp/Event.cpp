@@ -4,11 +4,11 @@
 
 namespace AdoCpp
 {
-    Event::Event* Event::newEvent(const Json::Value& json)
+    Event::Event* Event::newEvent(const Json::Value& json, const std::shared_ptr<StringPool>& strings)
     {
         const char* eventType = json["eventType"].asCString();
         if (strcmp(eventType, "SetSpeed") == 0)
-            return new GamePlay::SetSpeed(json);
+            return new GamePlay::SetSpeed(json, strings);
         if (strcmp(eventType, "Twirl") == 0)
             return new GamePlay::Twirl(json);
         if (strcmp(eventType, "Pause") == 0)
@@ -23,17 +23,17 @@ namespace AdoCpp
         if (strcmp(eventType, "AnimateTrack") == 0)
             return new Track::AnimateTrack(json);
         if (strcmp(eventType, "RecolorTrack") == 0)
-            return new Track::RecolorTrack(json);
+            return new Track::RecolorTrack(json, strings);
         if (strcmp(eventType, "PositionTrack") == 0)
             return new Track::PositionTrack(json);
         if (strcmp(eventType, "MoveTrack") == 0)
-            return new Track::MoveTrack(json);
+            return new Track::MoveTrack(json, strings);
 
         if (strcmp(eventType, "MoveCamera") == 0)
-            return new Visual::MoveCamera(json);
+            return new Visual::MoveCamera(json, strings);
 
         if (strcmp(eventType, "RepeatEvents") == 0)
-            return new Modifiers::RepeatEvents(json);
+            return new Modifiers::RepeatEvents(json, strings);
 
         if (strcmp(eventType, "Hold") == 0)
             return new Dlc::Hold(json);
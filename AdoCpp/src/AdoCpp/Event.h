@@ -16,5 +16,12 @@
  */
 namespace AdoCpp::Event
 {
-    Event* newEvent(const Json::Value& json);
+    /**
+     * @brief Convert json data into the event of its "eventType".
+     * @param json The json data.
+     * @param strings The pool to intern the tags in, usually Level::strings(). A new pool is created for the tags of
+     * the event if it is null.
+     * @return The new event, or nullptr if the event type is not supported.
+     */
+    Event* newEvent(const Json::Value& json, const std::shared_ptr<StringPool>& strings = nullptr);
 }
@@ -8,11 +8,11 @@ namespace AdoCpp::Event
         active = !data.isMember("active") || toBool(data["active"]);
     }
     StaticEvent::StaticEvent(const Json::Value& data) : Event(data) {}
-    DynamicEvent::DynamicEvent(const Json::Value& data) : Event(data)
+    DynamicEvent::DynamicEvent(const Json::Value& data, const std::shared_ptr<StringPool>& strings) : Event(data)
     {
         if (data.isMember("angleOffset"))
             angleOffset = data["angleOffset"].asDouble();
         if (data.isMember("eventTag"))
-            eventTag = cstr2tags(data["eventTag"].asCString());
+            eventTag = Tags(strings, data["eventTag"].asString());
     }
 } // namespace AdoCpp::Event
@@ -99,8 +99,9 @@ namespace AdoCpp::Event
         /**
          * Convert json data into DynamicEvent class.
          * @param data The json data.
+         * @param strings The pool to intern the tags in, usually Level::strings().
          */
-        explicit DynamicEvent(const Json::Value& data);
+        explicit DynamicEvent(const Json::Value& data, const std::shared_ptr<StringPool>& strings = nullptr);
         /**
          * @brief Clone the event.
          * @return the cloned event.
@@ -122,7 +123,7 @@ namespace AdoCpp::Event
         /**
          * @brief Tags of event.
          */
-        std::vector<std::string> eventTag;
+        Tags eventTag;
         /**
          * @brief Whether the event is not written in level data but generated by AdoCpp.
          */
@@ -3,7 +3,8 @@
 
 namespace AdoCpp::Event::GamePlay
 {
-    SetSpeed::SetSpeed(const Json::Value& data) : DynamicEvent(data)
+    SetSpeed::SetSpeed(const Json::Value& data, const std::shared_ptr<StringPool>& strings) :
+        DynamicEvent(data, strings)
     {
         beatsPerMinute = data["beatsPerMinute"].asDouble();
         if (!data.isMember("speedType"))
@@ -14,10 +14,10 @@ namespace AdoCpp::Event::GamePlay
             Multiplier
         };
         SetSpeed() = default;
-        explicit SetSpeed(const Json::Value& data);
+        explicit SetSpeed(const Json::Value& data, const std::shared_ptr<StringPool>& strings = nullptr);
         [[nodiscard]] constexpr bool stackable() const noexcept override { return true; }
         [[nodiscard]] constexpr const char* name() const noexcept override { return "SetSpeed"; }
-        [[nodiscard]] constexpr SetSpeed* clone() const override { return new SetSpeed(*this); }
+        [[nodiscard]] SetSpeed* clone() const override { return new SetSpeed(*this); }
         [[nodiscard]] Json::Value
         intoJson() const override;
         SpeedType speedType = SpeedType::Bpm;
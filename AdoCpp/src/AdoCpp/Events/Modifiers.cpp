@@ -2,7 +2,7 @@
 
 namespace AdoCpp::Event::Modifiers
 {
-    RepeatEvents::RepeatEvents(const Json::Value& data) : Event(data)
+    RepeatEvents::RepeatEvents(const Json::Value& data, const std::shared_ptr<StringPool>& strings) : Event(data)
     {
         if (data.isMember("repeatType") && !strcmp(data["repeatType"].asCString(), "Floor"))
             repeatType = RepeatType::Floor;
@@ -12,7 +12,7 @@ namespace AdoCpp::Event::Modifiers
         floorCount = data.isMember("floorCount") ? data["floorCount"].asUInt64() : 0;
         interval = data["interval"].asDouble();
         executeOnCurrentFloor = data.isMember("executeOnCurrentFloor") ? toBool(data["executeOnCurrentFloor"]) : false;
-        tag = cstr2tags(data["tag"].asCString());
+        tag = Tags(strings, data["tag"].asString());
     }
     Json::Value RepeatEvents::intoJson() const
     {
@@ -12,10 +12,10 @@ namespace AdoCpp::Event::Modifiers
             Floor
         };
         RepeatEvents() = default;
-        explicit RepeatEvents(const Json::Value& data);
+        explicit RepeatEvents(const Json::Value& data, const std::shared_ptr<StringPool>& strings = nullptr);
         [[nodiscard]] constexpr bool stackable() const noexcept override { return true; }
         [[nodiscard]] constexpr const char* name() const noexcept override { return "RepeatEvents"; }
-        [[nodiscard]] constexpr RepeatEvents* clone() const override { return new RepeatEvents(*this); }
+        [[nodiscard]] RepeatEvents* clone() const override { return new RepeatEvents(*this); }
         [[nodiscard]] Json::Value
         intoJson() const override;
         RepeatType repeatType = RepeatType::Beat;
@@ -23,7 +23,7 @@ namespace AdoCpp::Event::Modifiers
         size_t floorCount = 1;
         double interval = 1;
         bool executeOnCurrentFloor = false;
-        std::vector<std::string> tag;
+        Tags tag;
         double duration = 1;
     };
 } // namespace AdoCpp::Event::Modifiers
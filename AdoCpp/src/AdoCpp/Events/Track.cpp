@@ -87,7 +87,8 @@ namespace AdoCpp::Event::Track
             val["stickToFloors"] = *stickToFloors;
         return val;
     }
-    MoveTrack::MoveTrack(const Json::Value& data) : DynamicEvent(data)
+    MoveTrack::MoveTrack(const Json::Value& data, const std::shared_ptr<StringPool>& strings) :
+        DynamicEvent(data, strings)
     {
         startTile = RelativeIndex(data["startTile"]);
         endTile = RelativeIndex(data["endTile"]);
@@ -167,7 +168,8 @@ namespace AdoCpp::Event::Track
         autoRemoveDecimalPart(val, "beatsBehind", beatsBehind);
         return val;
     }
-    RecolorTrack::RecolorTrack(const Json::Value& data) : DynamicEvent(data)
+    RecolorTrack::RecolorTrack(const Json::Value& data, const std::shared_ptr<StringPool>& strings) :
+        DynamicEvent(data, strings)
     {
         startTile = RelativeIndex(data["startTile"]);
         endTile = RelativeIndex(data["endTile"]);
@@ -47,10 +47,10 @@ namespace AdoCpp::Event::Track
     {
     public:
         RecolorTrack() = default;
-        explicit RecolorTrack(const Json::Value& data);
+        explicit RecolorTrack(const Json::Value& data, const std::shared_ptr<StringPool>& strings = nullptr);
         [[nodiscard]] constexpr bool stackable() const noexcept override { return true; }
         [[nodiscard]] constexpr const char* name() const noexcept override { return "RecolorTrack"; }
-        [[nodiscard]] constexpr RecolorTrack* clone() const override { return new RecolorTrack(*this); }
+        [[nodiscard]] RecolorTrack* clone() const override { return new RecolorTrack(*this); }
         [[nodiscard]] Json::Value
         intoJson() const override;
         RelativeIndex startTile;
@@ -90,10 +90,10 @@ namespace AdoCpp::Event::Track
     {
     public:
         MoveTrack() = default;
-        explicit MoveTrack(const Json::Value& data);
+        explicit MoveTrack(const Json::Value& data, const std::shared_ptr<StringPool>& strings = nullptr);
         [[nodiscard]] constexpr bool stackable() const noexcept override { return true; }
         [[nodiscard]] constexpr const char* name() const noexcept override { return "MoveTrack"; }
-        [[nodiscard]] constexpr MoveTrack* clone() const override { return new MoveTrack(*this); }
+        [[nodiscard]] MoveTrack* clone() const override { return new MoveTrack(*this); }
         [[nodiscard]] Json::Value
         intoJson() const override;
         RelativeIndex startTile;
@@ -2,7 +2,8 @@
 
 namespace AdoCpp::Event::Visual
 {
-    MoveCamera::MoveCamera(const Json::Value& data) : DynamicEvent(data)
+    MoveCamera::MoveCamera(const Json::Value& data, const std::shared_ptr<StringPool>& strings) :
+        DynamicEvent(data, strings)
     {
         duration = data["duration"].asDouble();
         if (data.isMember("relativeTo"))
@@ -9,10 +9,10 @@ namespace AdoCpp::Event::Visual
     {
     public:
         MoveCamera() = default;
-        explicit MoveCamera(const Json::Value& data);
+        explicit MoveCamera(const Json::Value& data, const std::shared_ptr<StringPool>& strings = nullptr);
         [[nodiscard]] constexpr bool stackable() const noexcept override { return true; }
         [[nodiscard]] constexpr const char* name() const noexcept override { return "MoveCamera"; }
-        [[nodiscard]] constexpr MoveCamera* clone() const override { return new MoveCamera(*this); }
+        [[nodiscard]] MoveCamera* clone() const override { return new MoveCamera(*this); }
         [[nodiscard]] Json::Value intoJson() const override;
         double duration = 1;
         std::optional<RelativeToCamera> relativeTo;
@@ -0,0 +1,156 @@
+#include "Generator.h"
+#include <cmath>
+#include "Events/GamePlay.h"
+#include "Events/Modifiers.h"
+#include "Events/Track.h"
+#include "Events/Visual.h"
+
+namespace AdoCpp
+{
+    LevelGenerator::LevelGenerator(GeneratorOptions options) : m_options(std::move(options))
+    {
+        for (const char path : m_options.pathPattern)
+            m_pattern.push_back(path2angle(path));
+    }
+
+    void LevelGenerator::generate(Level& level) const
+    {
+        level.clear();
+        level.settings.bpm = m_options.bpm;
+        level.tiles.reserve(m_options.tileCount);
+        level.tiles.emplace_back(0);
+        std::mt19937_64 rng(m_options.seed);
+        double angle = 0;
+        for (size_t floor = 1; floor < m_options.tileCount; floor++)
+        {
+            std::vector<std::shared_ptr<Event::Event>> events;
+            nextTile(rng, floor, angle, &events, level.strings());
+            level.tiles.emplace_back(angle).events = std::move(events);
+        }
+    }
+
+    void LevelGenerator::write(std::ostream& os) const
+    {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        const std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+        Settings settings;
+        settings.bpm = m_options.bpm;
+
+        // The angles and the actions are separate arrays, so the level is generated twice with the same seed.
+        os << "{\"angleData\":[";
+        std::mt19937_64 rng(m_options.seed);
+        double angle = 0;
+        for (size_t floor = 1; floor < m_options.tileCount; floor++)
+        {
+            nextTile(rng, floor, angle, nullptr, nullptr);
+            os << (floor == 1 ? "" : ",") << angle;
+        }
+        os << "],\n\"settings\":";
+        writer->write(settings.intoJson(), &os);
+        os << ",\n\"actions\":[";
+        rng.seed(m_options.seed);
+        bool first = true;
+        std::vector<std::shared_ptr<Event::Event>> events;
+        const auto strings = std::make_shared<StringPool>();
+        for (size_t floor = 1; floor < m_options.tileCount; floor++)
+        {
+            events.clear();
+            nextTile(rng, floor, angle, &events, strings);
+            for (const auto& event : events)
+            {
+                os << (first ? "\n" : ",\n");
+                writer->write(event->intoJson(), &os);
+                first = false;
+            }
+        }
+        os << "\n],\n\"decorations\":[]}\n";
+    }
+
+    void LevelGenerator::nextTile(std::mt19937_64& rng, const size_t floor, double& angle,
+                                  std::vector<std::shared_ptr<Event::Event>>* events,
+                                  const std::shared_ptr<StringPool>& strings) const
+    {
+        std::uniform_real_distribution chance(0.0, 1.0);
+        const auto roll = [&](const double density) { return chance(rng) < density; };
+
+        // A midspin never follows another one or starts the level.
+        if (const bool afterMidspin = angle == 999; floor > 1 && !afterMidspin && roll(m_options.midspinDensity))
+            angle = 999;
+        else if (!m_pattern.empty())
+            angle = m_pattern[(floor - 1) % m_pattern.size()];
+        else
+        {
+            // Random turns in steps of 15 degrees, never straight back.
+            const double previous = afterMidspin ? 0 : angle;
+            const auto step = static_cast<double>(std::uniform_int_distribution(-11, 11)(rng));
+            angle = std::fmod(previous + step * 15 + 360, 360);
+        }
+
+        // Every draw happens even when events is null, so both passes of write() stay in step.
+        const bool setSpeed = roll(m_options.setSpeedDensity), twirl = roll(m_options.twirlDensity),
+                   moveTrack = roll(m_options.moveTrackDensity), recolorTrack = roll(m_options.recolorTrackDensity),
+                   moveCamera = roll(m_options.moveCameraDensity),
+                   repeatEvents = roll(m_options.repeatEventsDepth > 0 ? m_options.repeatEventsDensity : 0);
+        const double speed = std::exp((chance(rng) * 2 - 1) * std::log(std::max(1.0, m_options.maxSpeedFactor)));
+        const double x = chance(rng) - 0.5, y = chance(rng) - 0.5, rotation = chance(rng) * 30 - 15,
+                     opacity = 50 + chance(rng) * 50, zoom = 80 + chance(rng) * 80;
+        const auto color = static_cast<uint8_t>(std::uniform_int_distribution(0, 255)(rng));
+        if (!events)
+            return;
+
+        std::string tagList;
+        if (repeatEvents)
+            for (size_t i = 0; i < m_options.repeatEventsDepth; i++)
+                tagList += (i == 0 ? "r" : " r") + std::to_string(i);
+        const Tags tags(strings, tagList);
+        if (setSpeed)
+        {
+            const auto event = std::make_shared<Event::GamePlay::SetSpeed>();
+            event->floor = floor;
+            event->speedType = Event::GamePlay::SetSpeed::SpeedType::Bpm;
+            event->beatsPerMinute = m_options.bpm * speed;
+            events->push_back(event);
+        }
+        if (twirl)
+        {
+            const auto event = std::make_shared<Event::GamePlay::Twirl>();
+            event->floor = floor;
+            events->push_back(event);
+        }
+        if (moveTrack)
+        {
+            const auto event = std::make_shared<Event::Track::MoveTrack>();
+            event->floor = floor, event->eventTag = tags;
+            event->startTile = {0, ThisTile}, event->endTile = {8, ThisTile};
+            event->duration = 1, event->ease = Easing::OutSine;
+            event->positionOffset = {x, y}, event->rotationOffset = rotation, event->opacity = opacity;
+            events->push_back(event);
+        }
+        if (recolorTrack)
+        {
+            const auto event = std::make_shared<Event::Track::RecolorTrack>();
+            event->floor = floor, event->eventTag = tags;
+            event->startTile = {0, ThisTile}, event->endTile = {16, ThisTile};
+            event->trackColor = Color(color, 127, static_cast<uint8_t>(255 - color));
+            event->secondaryTrackColor = Color(255, 255, 255);
+            event->trackColorAnimDuration = 2;
+            events->push_back(event);
+        }
+        if (moveCamera)
+        {
+            const auto event = std::make_shared<Event::Visual::MoveCamera>();
+            event->floor = floor, event->eventTag = tags;
+            event->duration = 2, event->relativeTo = RelativeToCamera::Player, event->ease = Easing::InOutSine;
+            event->rotation = rotation, event->zoom = zoom;
+            events->push_back(event);
+        }
+        for (size_t i = 0; i < tags.size(); i++)
+        {
+            const auto event = std::make_shared<Event::Modifiers::RepeatEvents>();
+            event->floor = floor, event->tag = Tags(strings, tags[i]);
+            event->repetitions = m_options.repetitions, event->interval = 1;
+            events->push_back(event);
+        }
+    }
+} // namespace AdoCpp
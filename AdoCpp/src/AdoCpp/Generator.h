@@ -0,0 +1,91 @@
+#pragma once
+#include <ostream>
+#include <random>
+#include "Level.h"
+
+namespace AdoCpp
+{
+    /**
+     * @brief What LevelGenerator generates.
+     *
+     * A density is the chance of a tile getting an event of that type.
+     */
+    struct GeneratorOptions
+    {
+        /**
+         * @brief The number of tiles, including tile 0.
+         */
+        size_t tileCount = 1000;
+        /**
+         * @brief The same seed and options always generate the same level.
+         */
+        uint64_t seed = 0;
+        /**
+         * @brief The path as pathData letters (see paths in Utils.h), repeated to fill the level.
+         * Random turns when empty.
+         */
+        std::string pathPattern;
+        /**
+         * @brief The chance of a midspin (999) following a tile.
+         */
+        double midspinDensity = 0;
+
+        double bpm = 100;
+        double setSpeedDensity = 0.05;
+        /**
+         * @brief SetSpeed events pick a log-uniform BPM in [bpm / maxSpeedFactor, bpm * maxSpeedFactor].
+         */
+        double maxSpeedFactor = 2;
+        double twirlDensity = 0.05;
+        double moveTrackDensity = 0.02;
+        double recolorTrackDensity = 0.02;
+        double moveCameraDensity = 0.02;
+
+        double repeatEventsDensity = 0.01;
+        /**
+         * @brief How many RepeatEvents are stacked on a floor. Every event on the floor carries all their tags,
+         * so each of them is repeated once per RepeatEvents.
+         */
+        size_t repeatEventsDepth = 1;
+        size_t repetitions = 4;
+    };
+
+    /**
+     * @brief Generates synthetic levels for benchmarks and stress tests.
+     *
+     * The level is generated tile by tile from a seeded random engine, so it can either be built into a Level or
+     * streamed as ADOFAI JSON without ever holding the whole level in memory.
+     */
+    class LevelGenerator
+    {
+    public:
+        explicit LevelGenerator(GeneratorOptions options);
+
+        /**
+         * @brief Replace the level with a generated one. The level is not parsed.
+         * @param level The level.
+         */
+        void generate(Level& level) const;
+        /**
+         * @brief Write the level that generate() would build as ADOFAI JSON.
+         * @param os The output stream.
+         */
+        void write(std::ostream& os) const;
+
+    private:
+        /**
+         * @brief Generate the next tile. The random draws are the same whether events is null or not, so both
+         * passes of write() see the same level.
+         * @param floor The index of the tile.
+         * @param angle The previous angle in, the new angle out.
+         * @param events Receives the tile's events if not null.
+         * @param strings The pool to intern the tags of the events in.
+         */
+        void nextTile(std::mt19937_64& rng, size_t floor, double& angle,
+                      std::vector<std::shared_ptr<Event::Event>>* events,
+                      const std::shared_ptr<StringPool>& strings) const;
+
+        GeneratorOptions m_options;
+        std::vector<double> m_pattern;
+    };
+} // namespace AdoCpp
@@ -6,7 +6,10 @@
 #include <iostream>
 #include <optional>
 #include <ranges>
+#include <string_view>
+#include <unordered_map>
 
+#include "BinaryJson.h"
 #include "Utils.h"
 
 constexpr double positiveRemainder(const double a, const double b)
@@ -135,9 +138,20 @@ namespace AdoCpp
         parsed = false;
         settings = Settings();
         tiles.clear();
+        m_strings = std::make_shared<StringPool>();
         m_processedDynamicEvents.clear();
         m_setSpeeds.clear();
         m_speedData.clear();
+        m_tileBeats.clear();
+        m_tileSeconds.clear();
+        m_planetOrbits.clear();
+        m_tileAnimations.clear();
+        m_activeTileAnimations.clear();
+        m_nextTileAnimation = m_nextRecolor = 0;
+        m_colorAnimatedTiles.clear();
+        m_updatedSeconds = std::numeric_limits<double>::quiet_NaN();
+        m_tileFlags.clear();
+        m_changedTiles.clear();
     }
 
     void Level::defaultLevel()
@@ -174,12 +188,17 @@ namespace AdoCpp
         {
             try
             {
-                if (auto event = std::shared_ptr<Event::Event>(Event::newEvent(eventData)))
+                if (auto event = std::shared_ptr<Event::Event>(Event::newEvent(eventData, m_strings)))
+                {
+                    if (event->floor >= tiles.size())
+                        throw std::out_of_range("The floor of an event is out of range");
                     tiles[event->floor].events.push_back(event);
+                }
             }
             catch (std::exception& e)
             {
-                std::cout << e.what() << std::endl;
+                // Not std::cout, which may carry the output of a tool using the library.
+                std::cerr << e.what() << std::endl;
             }
         }
     }
@@ -198,7 +217,7 @@ namespace AdoCpp
     //         throw LevelJsonException(value.asParseError());
         Json::Value value;
         std::string err;
-        bool success = Json5::parse(ifs, value, &err);
+        bool success = BinaryJson::detect(ifs) ? BinaryJson::read(ifs, value, &err) : Json5::parse(ifs, value, &err);
         if (!success)
             throw LevelJsonException(err);
         fromJson(value);
@@ -206,7 +225,8 @@ namespace AdoCpp
 
     void Level::fromFile(const std::filesystem::path& path)
     {
-        std::ifstream ifs(path);
+        // Binary, so that a binary cache is read as is. The json parser treats '\r' as whitespace.
+        std::ifstream ifs(path, std::ios::binary);
         if (!ifs.is_open())
             throw LevelCouldNotOpenFileException();
         fromFile(ifs);
@@ -251,8 +271,14 @@ namespace AdoCpp
             return;
         assert(tiles.size() >= 2 && "AdoCpp::Level class must have at least two tiles to parse");
         parsed = true, onlyBasic = basic;
+        m_parseStats = {};
+        ADOCPP_PARSE_TIMER(m_parseStats, totalMs);
+        ADOCPP_PARSE_COUNT(m_parseStats, tiles, tiles.size());
+        m_updatedSeconds = std::numeric_limits<double>::quiet_NaN();
+        m_tileAnimations.clear();
         parseTiles(floorStart);
         parseSetSpeed();
+        parsePlanetOrbits();
         if (basic)
         {
             tiles[0].beat = tiles[0].seconds = -std::numeric_limits<double>::infinity();
@@ -265,7 +291,15 @@ namespace AdoCpp
         if (!m_disableAnimateTrack)
             parseAnimateTrack();
         parseRepeatEvents(dynamicEvents, vecRe);
-        m_processedDynamicEvents.sort([](const auto& a, const auto& b) { return a->beat < b->beat; }); // stable sort
+        {
+            ADOCPP_PARSE_TIMER(m_parseStats, sortEventsMs);
+            // The generated events go before the ones of the level, the last generated first, so that events at the
+            // same beat keep their order.
+            const auto generated = m_processedDynamicEvents.begin() + static_cast<std::ptrdiff_t>(dynamicEvents.size());
+            std::reverse(generated, m_processedDynamicEvents.end());
+            std::rotate(m_processedDynamicEvents.begin(), generated, m_processedDynamicEvents.end());
+            std::ranges::stable_sort(m_processedDynamicEvents, {}, &ProcessedEvent::beat);
+        }
         parseMoveTrackData();
 
         tiles[0].beat = tiles[0].seconds = -std::numeric_limits<double>::infinity();
@@ -274,33 +308,18 @@ namespace AdoCpp
     void Level::update()
     {
         assert(parsed && "AdoCpp::Level class is not parsed");
-        for (size_t i = 0; i < tiles.size(); i++)
-        {
-            auto& tile = tiles[i];
-            tile.pos.o2c(), tile.scale.o2c(), tile.rotation.o2c(), tile.opacity = 100;
-            tile.trackColorType.o2c(), tile.trackColor.o2c(), tile.secondaryTrackColor.o2c(),
-                tile.trackColorAnimDuration.o2c(), tile.trackStyle.o2c(), tile.trackColorPulse.o2c(),
-                tile.trackPulseLength.o2c();
-            updateTileColor(0, i);
-        }
+        resetTiles();
+        m_updatedSeconds = std::numeric_limits<double>::quiet_NaN();
     }
     void Level::update(const double seconds)
     {
         assert(parsed && "AdoCpp::Level class is not parsed");
-        update();
-        for (const auto& dynamicEvent : m_processedDynamicEvents)
-        {
-            if (seconds < dynamicEvent->seconds)
-                break;
-            if (auto recolorTrack = std::dynamic_pointer_cast<Event::Track::RecolorTrack>(dynamicEvent))
-                updateTileColorInfo(recolorTrack.get());
-        }
-
-        for (size_t i = 0; i < tiles.size(); i++)
-        {
-            updateTileColor(seconds, i);
-            updateTilePos(seconds, i);
-        }
+        // Going back would have to undo RecolorTrack, so it starts over from the original tiles.
+        if (seconds >= m_updatedSeconds && m_tileFlags.size() == tiles.size())
+            updateAnimatedTiles(seconds);
+        else
+            updateAllTiles(seconds);
+        m_updatedSeconds = seconds;
 
         {
             // const double beat = seconds2beat(seconds);
@@ -426,6 +445,12 @@ namespace AdoCpp
         unreachable();
     }
 
+    const std::vector<Level::SpeedData>& Level::getSpeedData() const noexcept
+    {
+        assert(parsed && "AdoCpp::Level class is not parsed");
+        return m_speedData;
+    }
+
     template <class Val, class Pred>
     auto Level::speedDataUpperBound(Val val, Pred pred) const
     {
@@ -441,33 +466,12 @@ namespace AdoCpp
     Angle Level::getPlanetsDir(const size_t floor, const double seconds) const
     {
         assert(parsed && "AdoCpp::Level class is not parsed");
-        auto it = speedDataUpperBound(std::make_tuple(floor, seconds), [](const auto& tuple, const SpeedData& sd)
-        {
-            const auto& [floor, seconds] = tuple;
-            return floor < sd.floor || seconds < sd.seconds; // FIXME
-        });
-        if (it != m_speedData.begin()) --it;
-        const double bpm = it->bpm, spb = bpm2crotchet(bpm);
-        // const double bpm = getBpm([&floor, &seconds](const Event::GamePlay::SetSpeed& ss)
-        //                           { return ss.floor <= floor && ss.seconds <= seconds; }),
-        //              spb = bpm2crotchet(bpm);
-        Angle angle;
-        if (floor == 0)
-        {
-            angle = -seconds / spb * degrees(180);
-        }
-        else
-        {
-            if (tiles[floor].angle.deg() == 999)
-                angle = tiles[floor - 1].angle;
-            else
-                angle = tiles[floor].angle + degrees(180);
-            if (tiles[floor].orbit == Clockwise)
-                angle -= ((seconds - tiles[floor].seconds) / spb) * degrees(180);
-            else
-                angle += ((seconds - tiles[floor].seconds) / spb) * degrees(180);
-        }
-        return angle;
+        const PlanetOrbit& orbit = m_planetOrbits[floor];
+        Angle velocity = orbit.velocity;
+        // Before a change of the bpm on this tile, e.g. a too early hit: use the bpm at that time.
+        if (seconds < m_speedData[orbit.speedIndex].seconds)
+            velocity = orbit.direction * degrees(180) / bpm2crotchet(getBpmBySeconds(seconds));
+        return orbit.startAngle + velocity * (seconds - orbit.startSeconds);
     }
     std::pair<Vector2lf, Vector2lf> Level::getPlanetsPos(const size_t floor, const double seconds) const
     {
@@ -479,20 +483,80 @@ namespace AdoCpp
             return std::make_pair(p1, p2);
         return std::make_pair(p2, p1);
     }
+    std::vector<std::pair<Vector2lf, Vector2lf>> Level::samplePlanetsPos(const double begin, const double end,
+                                                                         const size_t count) const
+    {
+        assert(parsed && "AdoCpp::Level class is not parsed");
+        std::vector<std::pair<Vector2lf, Vector2lf>> positions;
+        positions.reserve(count);
+        size_t floor = getFloorBySeconds(begin);
+        for (size_t i = 0; i < count; i++)
+        {
+            const double seconds =
+                count == 1 ? begin : begin + (end - begin) * static_cast<double>(i) / static_cast<double>(count - 1);
+            floor = getFloorBySeconds(seconds, floor);
+            positions.push_back(getPlanetsPos(floor, seconds));
+        }
+        return positions;
+    }
     bool Level::isFirePlanetStatic(const size_t floor) { return floor % 2 == 0; }
+    /**
+     * std::upper_bound of the sorted values, searched by doubling the step from the hint until the value is passed.
+     */
+    static size_t gallopUpperBound(const std::vector<double>& values, const double value, size_t hint)
+    {
+        const size_t n = values.size();
+        hint = std::min(hint, n);
+        size_t lo = 0, hi = n;
+        if (hint < n && values[hint] <= value)
+        {
+            lo = hint + 1;
+            for (size_t step = 1; hint + step < n; step *= 2)
+            {
+                if (values[hint + step] > value)
+                {
+                    hi = hint + step;
+                    break;
+                }
+                lo = hint + step + 1;
+            }
+        }
+        else
+        {
+            hi = hint;
+            for (size_t step = 1; step <= hint; step *= 2)
+            {
+                if (values[hint - step] <= value)
+                {
+                    lo = hint - step + 1;
+                    break;
+                }
+                hi = hint - step;
+            }
+        }
+        const auto begin = values.begin() + static_cast<std::ptrdiff_t>(lo),
+                   end = values.begin() + static_cast<std::ptrdiff_t>(hi);
+        return static_cast<size_t>(std::upper_bound(begin, end, value) - values.begin());
+    }
     size_t Level::getFloorByBeat(const double beat) const
     {
         assert(parsed && "AdoCpp::Level class is not parsed");
-        return std::upper_bound(tiles.begin() + 1, tiles.end(), beat,
-                                [](const double& val, const Tile& e) -> bool { return val < e.beat; }) -
-            (tiles.begin() + 1);
+        return std::upper_bound(m_tileBeats.begin(), m_tileBeats.end(), beat) - m_tileBeats.begin();
     }
     size_t Level::getFloorBySeconds(const double seconds) const
     {
         assert(parsed && "AdoCpp::Level class is not parsed");
-        return std::upper_bound(tiles.begin() + 1, tiles.end(), seconds,
-                                [](const double& val, const Tile& e) -> bool { return val < e.seconds; }) -
-            (tiles.begin() + 1);
+        return std::upper_bound(m_tileSeconds.begin(), m_tileSeconds.end(), seconds) - m_tileSeconds.begin();
+    }
+    size_t Level::getFloorByBeat(const double beat, const size_t hint) const
+    {
+        assert(parsed && "AdoCpp::Level class is not parsed");
+        return gallopUpperBound(m_tileBeats, beat, hint);
+    }
+    size_t Level::getFloorBySeconds(const double seconds, const size_t hint) const
+    {
+        assert(parsed && "AdoCpp::Level class is not parsed");
+        return gallopUpperBound(m_tileSeconds, seconds, hint);
     }
     double Level::getBpm(const std::function<bool(const Event::GamePlay::SetSpeed&)>& func) const
     {
@@ -657,6 +721,8 @@ namespace AdoCpp
     }
 
     bool Level::isParsed() const noexcept { return parsed; }
+    const ParseStats& Level::parseStats() const noexcept { return m_parseStats; }
+    const std::shared_ptr<StringPool>& Level::strings() const noexcept { return m_strings; }
 
     bool Level::disableAnimateTrack() const { return m_disableAnimateTrack; }
     void Level::disableAnimateTrack(const bool disable)
@@ -668,6 +734,7 @@ namespace AdoCpp
 
     void Level::parseTiles(const size_t beginFloor)
     {
+        ADOCPP_PARSE_TIMER(m_parseStats, parseTilesMs);
         // clang-format off
         std::vector<bool>                                          twirls(tiles.size());
         std::vector<double>                                        pauses(tiles.size());
@@ -683,6 +750,7 @@ namespace AdoCpp
                 event->floor = floor;
                 if (!event->active)
                     continue;
+                ADOCPP_PARSE_COUNT(m_parseStats, events, 1);
 
                 if (typeid(*event.get()) == typeid(Event::GamePlay::Twirl))
                     twirls[event->floor] = true;
@@ -836,6 +904,7 @@ namespace AdoCpp
     }
     void Level::parseSetSpeed()
     {
+        ADOCPP_PARSE_TIMER(m_parseStats, parseSetSpeedMs);
         m_setSpeeds.clear();
         for (const auto& tile : tiles)
         {
@@ -847,6 +916,7 @@ namespace AdoCpp
                         m_setSpeeds.push_back(setSpeed);
             }
         }
+        ADOCPP_PARSE_COUNT(m_parseStats, setSpeeds, m_setSpeeds.size());
         m_speedData.clear();
         double bpm = settings.bpm, lastBeat = 0, deltaBeat = 0, seconds = settings.offset / 1000;
         m_speedData.push_back(
@@ -864,10 +934,36 @@ namespace AdoCpp
         }
         for (auto& tile : tiles)
             tile.seconds = beat2seconds(tile.beat);
+        m_tileBeats.resize(tiles.size() - 1), m_tileSeconds.resize(tiles.size() - 1);
+        for (size_t i = 1; i < tiles.size(); i++)
+            m_tileBeats[i - 1] = tiles[i].beat, m_tileSeconds[i - 1] = tiles[i].seconds;
+    }
+    void Level::parsePlanetOrbits()
+    {
+        ADOCPP_PARSE_TIMER(m_parseStats, parsePlanetOrbitsMs);
+        m_planetOrbits.resize(tiles.size());
+        size_t speedIndex = 0;
+        for (size_t i = 0; i < tiles.size(); i++)
+        {
+            while (speedIndex + 1 < m_speedData.size() && m_speedData[speedIndex + 1].floor <= i)
+                speedIndex++;
+            PlanetOrbit& orbit = m_planetOrbits[i];
+            if (i == 0)
+                orbit.startAngle = degrees(0), orbit.startSeconds = 0, orbit.direction = -1;
+            else
+            {
+                orbit.startAngle = tiles[i].angle.deg() == 999 ? tiles[i - 1].angle : tiles[i].angle + degrees(180);
+                orbit.startSeconds = tiles[i].seconds;
+                orbit.direction = tiles[i].orbit == Clockwise ? -1 : 1;
+            }
+            orbit.velocity = orbit.direction * degrees(180) / bpm2crotchet(m_speedData[speedIndex].bpm);
+            orbit.speedIndex = speedIndex;
+        }
     }
     void Level::parseDynamicEvents(std::vector<Event::DynamicEvent*>& dynamicEvents,
                                    std::vector<std::vector<Event::Modifiers::RepeatEvents*>>& vecRe)
     {
+        ADOCPP_PARSE_TIMER(m_parseStats, parseDynamicEventsMs);
         m_processedDynamicEvents.clear();
 
         for (const auto& tile : tiles)
@@ -895,7 +991,9 @@ namespace AdoCpp
                     }
 
                     dynamicEvents.push_back(dynamicEventPtr.get());
-                    m_processedDynamicEvents.push_back(dynamicEventPtr);
+                    addProcessedEvent(dynamicEventPtr, dynamicEventPtr->beat, dynamicEventPtr->seconds,
+                                      dynamicEventPtr->floor);
+                    ADOCPP_PARSE_COUNT(m_parseStats, dynamicEvents, 1);
                 }
                 if (auto repeatEvents = std::dynamic_pointer_cast<Event::Modifiers::RepeatEvents>(event))
                 {
@@ -906,6 +1004,7 @@ namespace AdoCpp
     }
     void Level::parseAnimateTrack()
     {
+        ADOCPP_PARSE_TIMER(m_parseStats, parseAnimateTrackMs);
         // AnimateTrack // FIXME
         for (size_t i = 0; i < tiles.size(); i++)
         {
@@ -933,8 +1032,10 @@ namespace AdoCpp
                         mtAppear->duration = 0.5;
                         mtAppear->opacity = 100;
                         mtHide->generated = mtAppear->generated = true;
-                        m_processedDynamicEvents.push_front(mtHide);
-                        m_processedDynamicEvents.push_front(mtAppear);
+                        addProcessedEvent(mtHide, mtHide->beat, mtHide->seconds, i);
+                        addProcessedEvent(mtAppear, mtAppear->beat, mtAppear->seconds, i);
+                        ADOCPP_PARSE_COUNT(m_parseStats, animateTrackEvents, 2);
+                        ADOCPP_PARSE_COUNT(m_parseStats, allocations, 2); // make_shared
                         break;
                     }
                 case TrackAnimation::Grow_Spin:
@@ -953,8 +1054,10 @@ namespace AdoCpp
                         mtAppear->rotationOffset = 0;
                         mtAppear->scale = OptionalPoint(std::make_optional(100.0), std::make_optional(100.0));
                         mtHide->generated = mtAppear->generated = true;
-                        m_processedDynamicEvents.push_front(mtHide);
-                        m_processedDynamicEvents.push_front(mtAppear);
+                        addProcessedEvent(mtHide, mtHide->beat, mtHide->seconds, i);
+                        addProcessedEvent(mtAppear, mtAppear->beat, mtAppear->seconds, i);
+                        ADOCPP_PARSE_COUNT(m_parseStats, animateTrackEvents, 2);
+                        ADOCPP_PARSE_COUNT(m_parseStats, allocations, 2); // make_shared
                         break;
                     }
                 }
@@ -976,7 +1079,9 @@ namespace AdoCpp
                         mtDisappear->duration = 0.5;
                         mtDisappear->opacity = 0;
                         mtDisappear->generated = true;
-                        m_processedDynamicEvents.insert(m_processedDynamicEvents.begin(), mtDisappear);
+                        addProcessedEvent(mtDisappear, mtDisappear->beat, mtDisappear->seconds, i);
+                        ADOCPP_PARSE_COUNT(m_parseStats, animateTrackEvents, 1);
+                        ADOCPP_PARSE_COUNT(m_parseStats, allocations, 1); // make_shared
                         break;
                     }
                 case TrackDisappearAnimation::Shrink_Spin:
@@ -990,7 +1095,9 @@ namespace AdoCpp
                         mtDisappear->rotationOffset = 180;
                         mtDisappear->scale = OptionalPoint(std::make_optional(0.0), std::make_optional(0.0));
                         mtDisappear->generated = true;
-                        m_processedDynamicEvents.insert(m_processedDynamicEvents.begin(), mtDisappear);
+                        addProcessedEvent(mtDisappear, mtDisappear->beat, mtDisappear->seconds, i);
+                        ADOCPP_PARSE_COUNT(m_parseStats, animateTrackEvents, 1);
+                        ADOCPP_PARSE_COUNT(m_parseStats, allocations, 1); // make_shared
                         break;
                     }
                 }
@@ -1000,57 +1107,94 @@ namespace AdoCpp
     void Level::parseRepeatEvents(const std::vector<Event::DynamicEvent*>& dynamicEvents,
                                   const std::vector<std::vector<Event::Modifiers::RepeatEvents*>>& vecRe)
     {
-        for (const auto& event : dynamicEvents)
-            for (const auto& repeatEvents : vecRe[event->floor])
-                for (const auto& tag : repeatEvents->tag)
-                    for (const auto& eventTag : event->eventTag)
+        ADOCPP_PARSE_TIMER(m_parseStats, parseRepeatEventsMs);
+        // Index the events by floor and the id of the tag in m_strings, so that matching does not compare strings.
+        // The tags read by fromJson already have their ids; only the tags of events made elsewhere are interned
+        // here. Only the floors with RepeatEvents are indexed, as the others repeat nothing.
+        // The events are the first ones of m_processedDynamicEvents, in the same order.
+        std::unordered_map<uint64_t, std::vector<size_t>> eventsByFloorTag;
+        const auto key = [](const size_t floor, const StringPool::Id tagId)
+        { return static_cast<uint64_t>(floor) << 32 | tagId; };
+        for (size_t i = 0; i < dynamicEvents.size(); i++)
+        {
+            const Tags& eventTag = dynamicEvents[i]->eventTag;
+            if (vecRe[dynamicEvents[i]->floor].empty())
+                continue;
+            for (size_t j = 0; j < eventTag.size(); j++)
+            {
+                const StringPool::Id tagId =
+                    eventTag.pool() == m_strings ? eventTag.id(j) : m_strings->intern(eventTag[j]);
+                eventsByFloorTag[key(dynamicEvents[i]->floor, tagId)].push_back(i);
+            }
+        }
+
+        for (size_t floor = 0; floor < vecRe.size(); floor++)
+            for (const auto& repeatEvents : vecRe[floor])
+                for (size_t j = 0; j < repeatEvents->tag.size(); j++)
+                {
+                    // A tag that no event has may not be in the pool.
+                    const Tags& tag = repeatEvents->tag;
+                    const std::optional<StringPool::Id> tagId =
+                        tag.pool() == m_strings ? std::make_optional(tag.id(j)) : m_strings->find(tag[j]);
+                    if (!tagId)
+                        continue;
+                    const auto it = eventsByFloorTag.find(key(floor, *tagId));
+                    if (it == eventsByFloorTag.end())
+                        continue;
+                    for (const size_t index : it->second)
                     {
-                        if (tag != eventTag)
-                            continue;
+                        // The repetitions share the event instead of cloning it.
+                        const Event::DynamicEvent* event = dynamicEvents[index];
+                        const std::shared_ptr<Event::DynamicEvent> shared = m_processedDynamicEvents[index].event;
                         const double spb = bpm2crotchet(getBpmByBeat(event->beat + event->angleOffset / 180));
                         if (repeatEvents->repeatType == Event::Modifiers::RepeatEvents::RepeatType::Beat)
                         {
                             const double gap = spb * repeatEvents->interval;
                             for (size_t i = 1; i <= repeatEvents->repetitions; i++)
                             {
-                                const auto eventClone = event->clone();
-                                eventClone->seconds += gap * static_cast<double>(i);
-                                eventClone->beat = seconds2beat(eventClone->seconds);
-                                eventClone->generated = true;
-                                m_processedDynamicEvents.push_front(std::shared_ptr<Event::DynamicEvent>(eventClone));
+                                const double seconds = event->seconds + gap * static_cast<double>(i);
+                                addProcessedEvent(shared, seconds2beat(seconds), seconds, event->floor);
+                                ADOCPP_PARSE_COUNT(m_parseStats, repeatedEvents, 1);
                             }
                         }
                         else if (repeatEvents->repeatType == Event::Modifiers::RepeatEvents::RepeatType::Floor)
                         {
-                            for (size_t i = 1; i <= repeatEvents->floorCount; i++)
+                            for (size_t i = 1; i <= repeatEvents->floorCount && event->floor + i < tiles.size(); i++)
                             {
-                                const auto eventClone = event->clone();
-                                eventClone->seconds =
-                                    tiles[eventClone->floor + i].seconds + eventClone->angleOffset / 180 * spb;
-                                eventClone->beat = seconds2beat(eventClone->seconds);
-                                if (repeatEvents->executeOnCurrentFloor)
-                                    eventClone->floor += i;
-                                eventClone->generated = true;
-                                m_processedDynamicEvents.push_front(std::shared_ptr<Event::DynamicEvent>(eventClone));
+                                const double seconds = tiles[event->floor + i].seconds + event->angleOffset / 180 * spb;
+                                const size_t target = repeatEvents->executeOnCurrentFloor ? event->floor + i
+                                                                                          : event->floor;
+                                addProcessedEvent(shared, seconds2beat(seconds), seconds, target);
+                                ADOCPP_PARSE_COUNT(m_parseStats, repeatedEvents, 1);
                             }
                         }
                     }
+                }
+    }
+    void Level::addProcessedEvent(std::shared_ptr<Event::DynamicEvent> event, const double beat, const double seconds,
+                                  const size_t floor)
+    {
+        [[maybe_unused]] const size_t capacity = m_processedDynamicEvents.capacity();
+        m_processedDynamicEvents.push_back({std::move(event), beat, seconds, floor});
+        ADOCPP_PARSE_COUNT(m_parseStats, allocations, m_processedDynamicEvents.capacity() != capacity);
     }
     void Level::parseMoveTrackData()
     {
-        for (const auto& event : m_processedDynamicEvents)
+        ADOCPP_PARSE_TIMER(m_parseStats, parseMoveTrackDataMs);
+        for (const auto& [event, beat, seconds, floor] : m_processedDynamicEvents)
         {
-            const auto mt = std::dynamic_pointer_cast<Event::Track::MoveTrack>(event);
+            const auto mt = dynamic_cast<const Event::Track::MoveTrack*>(event.get());
             if (mt == nullptr)
                 continue;
-            size_t b = std::max(0ull, rel2absIndex(mt->floor, mt->startTile)),
-                   e = std::min(tiles.size() - 1, rel2absIndex(mt->floor, mt->endTile));
+            size_t b = rel2absIndex(floor, mt->startTile),
+                   e = std::min(tiles.size() - 1, rel2absIndex(floor, mt->endTile));
             if (b > e) std::swap(b, e);
             for (size_t i = b; i <= e; i++)
             {
                 auto& d = tiles[i].moveTrackDatas;
+                [[maybe_unused]] const size_t capacity = d.capacity();
                 // clang-format off
-                d.emplace_back(mt->floor, mt->angleOffset, mt->beat, mt->seconds, mt->startTile, mt->endTile,
+                d.emplace_back(floor, mt->angleOffset, beat, seconds, mt->startTile, mt->endTile,
                                mt->duration,
                                mt->positionOffset, 114514, 114514,
                                mt->rotationOffset, 114514,
@@ -1058,6 +1202,8 @@ namespace AdoCpp
                                mt->opacity, 114514,
                                mt->ease);
                 // clang-format on
+                ADOCPP_PARSE_COUNT(m_parseStats, moveTrackRecords, 1);
+                ADOCPP_PARSE_COUNT(m_parseStats, allocations, d.capacity() != capacity);
             }
         }
         for (auto& tile : tiles)
@@ -1087,8 +1233,146 @@ namespace AdoCpp
                     opEndSec = moveTrackData.seconds;
             }
         }
+        // A tile stops moving once each of its MoveTracks has eased to the end.
+        for (size_t i = 0; i < tiles.size(); i++)
+        {
+            const size_t first = m_tileAnimations.size();
+            for (const auto& data : tiles[i].moveTrackDatas)
+            {
+                const double spb = bpm2crotchet(getBpmForDynamicEvent(data.floor, data.angleOffset));
+                const double endSeconds = std::max(data.seconds, data.seconds + data.duration * spb);
+                m_tileAnimations.push_back({data.seconds, endSeconds, i});
+            }
+            if (first == m_tileAnimations.size())
+                continue;
+            const auto begin = m_tileAnimations.begin() + static_cast<std::ptrdiff_t>(first);
+            std::ranges::sort(begin, m_tileAnimations.end(), {}, &TileAnimation::beginSeconds);
+            auto merged = begin;
+            for (auto it = begin + 1; it != m_tileAnimations.end(); ++it)
+                if (it->beginSeconds <= merged->endSeconds)
+                    merged->endSeconds = std::max(merged->endSeconds, it->endSeconds);
+                else
+                    *++merged = *it;
+            m_tileAnimations.erase(merged + 1, m_tileAnimations.end());
+        }
+        std::ranges::stable_sort(m_tileAnimations, {}, &TileAnimation::beginSeconds);
+    }
+    void Level::takeChangedTiles(std::vector<size_t>& changedTiles)
+    {
+        changedTiles.clear();
+        std::swap(changedTiles, m_changedTiles);
+        for (const size_t i : changedTiles)
+            m_tileFlags[i] &= ~TileChanged;
+    }
+    void Level::resetTiles()
+    {
+        // The indices of a different tile count mean nothing, and every tile is marked below anyway.
+        if (m_tileFlags.size() != tiles.size())
+            m_tileFlags.assign(tiles.size(), 0), m_changedTiles.clear();
+        m_colorAnimatedTiles.clear();
+        for (size_t i = 0; i < tiles.size(); i++)
+        {
+            auto& tile = tiles[i];
+            tile.pos.o2c(), tile.scale.o2c(), tile.rotation.o2c(), tile.opacity = 100;
+            tile.trackColorType.o2c(), tile.trackColor.o2c(), tile.secondaryTrackColor.o2c(),
+                tile.trackColorAnimDuration.o2c(), tile.trackStyle.o2c(), tile.trackColorPulse.o2c(),
+                tile.trackPulseLength.o2c();
+            updateTileColor(0, i);
+            m_tileFlags[i] &= ~(TileColorAnimated | TileInColorList);
+            markTileChanged(i);
+        }
+    }
+    void Level::updateAllTiles(const double seconds)
+    {
+        resetTiles();
+        for (m_nextRecolor = 0; m_nextRecolor < m_processedDynamicEvents.size(); m_nextRecolor++)
+        {
+            const auto& [event, beat, eventSeconds, floor] = m_processedDynamicEvents[m_nextRecolor];
+            if (seconds < eventSeconds)
+                break;
+            if (const auto recolorTrack = dynamic_cast<const Event::Track::RecolorTrack*>(event.get()))
+                updateTileColorInfo(recolorTrack, floor, seconds);
+        }
+        for (size_t i = 0; i < tiles.size(); i++)
+        {
+            updateTileColor(seconds, i), trackColorAnimation(i);
+            updateTilePos(seconds, i);
+        }
+
+        const auto next = std::ranges::upper_bound(m_tileAnimations, seconds, {}, &TileAnimation::beginSeconds);
+        m_nextTileAnimation = static_cast<size_t>(next - m_tileAnimations.begin());
+        m_activeTileAnimations.clear();
+        for (auto it = m_tileAnimations.begin(); it != next; ++it)
+            if (seconds < it->endSeconds)
+                m_activeTileAnimations.push_back(*it);
+    }
+    void Level::updateAnimatedTiles(const double seconds)
+    {
+        for (; m_nextRecolor < m_processedDynamicEvents.size(); m_nextRecolor++)
+        {
+            const auto& [event, beat, eventSeconds, floor] = m_processedDynamicEvents[m_nextRecolor];
+            if (seconds < eventSeconds)
+                break;
+            if (const auto recolorTrack = dynamic_cast<const Event::Track::RecolorTrack*>(event.get()))
+                updateTileColorInfo(recolorTrack, floor, seconds);
+        }
+        for (size_t k = 0; k < m_colorAnimatedTiles.size();)
+        {
+            const size_t i = m_colorAnimatedTiles[k];
+            if (!(m_tileFlags[i] & TileColorAnimated))
+            {
+                m_tileFlags[i] &= ~TileInColorList;
+                m_colorAnimatedTiles[k] = m_colorAnimatedTiles.back(), m_colorAnimatedTiles.pop_back();
+                continue;
+            }
+            updateTileColor(seconds, i), markTileChanged(i), k++;
+        }
+
+        for (; m_nextTileAnimation < m_tileAnimations.size() &&
+               m_tileAnimations[m_nextTileAnimation].beginSeconds <= seconds;
+             m_nextTileAnimation++)
+            m_activeTileAnimations.push_back(m_tileAnimations[m_nextTileAnimation]);
+        for (size_t k = 0; k < m_activeTileAnimations.size();)
+        {
+            // Every MoveTrack of the tile so far is replayed, as each one eases from where the previous ones left.
+            const auto [beginSeconds, endSeconds, i] = m_activeTileAnimations[k];
+            auto& tile = tiles[i];
+            tile.pos.o2c(), tile.scale.o2c(), tile.rotation.o2c(), tile.opacity = 100;
+            updateTilePos(seconds, i), markTileChanged(i);
+            if (seconds >= endSeconds)
+                m_activeTileAnimations[k] = m_activeTileAnimations.back(), m_activeTileAnimations.pop_back();
+            else
+                k++;
+        }
+    }
+    void Level::markTileChanged(const size_t i)
+    {
+        if (!(m_tileFlags[i] & TileChanged))
+            m_tileFlags[i] |= TileChanged, m_changedTiles.push_back(i);
+    }
+    void Level::trackColorAnimation(const size_t i)
+    {
+        // Only these color types depend on the time, and only with an animation duration.
+        bool animated = false;
+        switch (tiles[i].trackColorType.c)
+        {
+        case TrackColorType::Glow:
+        case TrackColorType::Blink:
+        case TrackColorType::Switch:
+        case TrackColorType::Rainbow:
+        case TrackColorType::Volume:
+            animated = tiles[i].trackColorAnimDuration.c != 0;
+            break;
+        default:
+            break;
+        }
+        if (!animated)
+            m_tileFlags[i] &= ~TileColorAnimated; // dropped from m_colorAnimatedTiles by the next update
+        else if (m_tileFlags[i] |= TileColorAnimated; !(m_tileFlags[i] & TileInColorList))
+            m_tileFlags[i] |= TileInColorList, m_colorAnimatedTiles.push_back(i);
     }
-    void Level::updateTileColorInfo(const Event::Track::RecolorTrack* const recolorTrack)
+    void Level::updateTileColorInfo(const Event::Track::RecolorTrack* const recolorTrack, const size_t floor,
+                                    const double seconds)
     {
         // double x, y;
         // if (!recolorTrack->duration || recolorTrack->duration == 0)
@@ -1097,8 +1381,8 @@ namespace AdoCpp
         //     x = (seconds - recolorTrack->seconds) /
         //         (*recolorTrack->duration * bpm2crotchet(getBpmByBeat(recolorTrack->beat))),
         //     y = ease(recolorTrack->ease, x);
-        size_t b = std::max(0ull, rel2absIndex(recolorTrack->floor, recolorTrack->startTile)),
-               e = std::min(tiles.size() - 1, rel2absIndex(recolorTrack->floor, recolorTrack->endTile));
+        size_t b = rel2absIndex(floor, recolorTrack->startTile),
+               e = std::min(tiles.size() - 1, rel2absIndex(floor, recolorTrack->endTile));
         if (b > e) std::swap(b, e);
         for (size_t i = b; i <= e; i++)
         {
@@ -1109,6 +1393,7 @@ namespace AdoCpp
             tiles[i].trackColorPulse.c = recolorTrack->trackColorPulse;
             tiles[i].trackPulseLength.c = recolorTrack->trackPulseLength;
             tiles[i].trackColorAnimDuration.c = recolorTrack->trackColorAnimDuration;
+            updateTileColor(seconds, i), trackColorAnimation(i), markTileChanged(i);
         }
     }
 
@@ -2,12 +2,13 @@
 #include <filesystem>
 #include <fstream>
 #include <functional>
-#include <list>
+#include <limits>
 #include <vector>
 #include <json5cpp.h>
 
 #include "Event.h"
 #include "Math/Vector2.h"
+#include "ParseStats.h"
 #include "Tile.h"
 #include "Utils.h"
 
@@ -164,6 +165,15 @@ namespace AdoCpp
         explicit Level(const std::filesystem::path& path);
 
         Level(const Level&) = delete;
+        /**
+         * Lets a level be loaded and parsed elsewhere (e.g. on a worker thread) and swapped in afterwards.
+         * @brief Move constructor.
+         */
+        Level(Level&&) noexcept = default;
+        /**
+         * @brief Move assignment operator.
+         */
+        Level& operator=(Level&&) noexcept = default;
 
         /**
          * @brief Default destructor.
@@ -188,12 +198,12 @@ namespace AdoCpp
         void fromJson(const Json::Value& value);
 
         /**
-         * @brief Import a file into the level (encoded in UTF-8 BOM).
+         * @brief Import a file into the level (encoded in UTF-8 BOM, or a cache written by BinaryJson::write).
          * @param ifs The input file stream.
          */
         void fromFile(std::ifstream& ifs);
         /**
-         * @brief Import a file into the level (encoded in UTF-8 BOM).
+         * @brief Import a file into the level (encoded in UTF-8 BOM, or a cache written by BinaryJson::write).
          * @param path The path to the file.
          */
         void fromFile(const std::filesystem::path& path);
@@ -211,9 +221,22 @@ namespace AdoCpp
         void update();
         /**
          * @brief Update the level.
+         *
+         * Going forward only touches the tiles that RecolorTrack, MoveTrack or an animated track color changes.
+         * The first update after parse() or update(), and any update going back in time, recompute every tile.
          * @param seconds The seconds.
          */
         void update(double seconds);
+        /**
+         * @brief Take the indices of the tiles whose position, scale, rotation, opacity, color or style may have
+         * changed since the last call.
+         *
+         * Renderers only need to touch these tiles. The indices pile up over update() calls until they are taken,
+         * each index at most once.
+         * @param changedTiles Receives the indices. Its old contents are dropped, and its memory is reused by the
+         * level, so passing the same vector every frame does not allocate.
+         */
+        void takeChangedTiles(std::vector<size_t>& changedTiles);
 
         /**
          * @brief Insert the tile.
@@ -281,6 +304,16 @@ namespace AdoCpp
          */
         [[nodiscard]] std::pair<Vector2lf, Vector2lf> getPlanetsPos(size_t floor, double seconds) const;
 
+        /**
+         * @brief Sample the position of the two planets over a time range, e.g. for a preview or a trail.
+         * @param begin The seconds of the first sample.
+         * @param end The seconds of the last sample.
+         * @param count The number of samples, evenly spaced from begin to end.
+         * @return The position of the two planets at each sample.
+         */
+        [[nodiscard]] std::vector<std::pair<Vector2lf, Vector2lf>> samplePlanetsPos(double begin, double end,
+                                                                                    size_t count) const;
+
         [[nodiscard]] static bool isFirePlanetStatic(size_t floor);
 
         /**
@@ -297,6 +330,44 @@ namespace AdoCpp
          */
         [[nodiscard]] size_t getFloorBySeconds(double seconds) const;
 
+        /**
+         * @brief Get the index of the tile that one of the planets lands on, searching from a previous result.
+         *
+         * Gallops from the hint towards the answer, so a playback that moves forward a few tiles per frame takes
+         * O(1) amortized time instead of a binary search over all the tiles.
+         * @param beat The beat.
+         * @param hint A nearby index, e.g. the result of the last frame.
+         * @return The index of the tile.
+         */
+        [[nodiscard]] size_t getFloorByBeat(double beat, size_t hint) const;
+
+        /**
+         * @brief Get the index of the tile that one of the planets lands on, searching from a previous result.
+         * @param seconds The seconds.
+         * @param hint A nearby index, e.g. the result of the last frame.
+         * @return The index of the tile.
+         */
+        [[nodiscard]] size_t getFloorBySeconds(double seconds, size_t hint) const;
+
+        /**
+         * @brief A change of the bpm, i.e. the start of a straight line of the beat-to-seconds mapping.
+         */
+        struct SpeedData
+        {
+            double beat;
+            double seconds;
+            double bpm;
+
+            size_t floor;
+            double angleOffset;
+        };
+
+        /**
+         * @brief Get the bpm changes of the level, in order.
+         * @return The bpm changes. The first one, at -infinity, holds the bpm of the settings.
+         */
+        [[nodiscard]] const std::vector<SpeedData>& getSpeedData() const noexcept;
+
         template <class Val, class Pred>
         auto speedDataUpperBound(Val val, Pred pred) const;
 
@@ -386,6 +457,19 @@ namespace AdoCpp
          * @return Whether the level has been parsed.
          */
         [[nodiscard]] bool isParsed() const noexcept;
+        /**
+         * @brief Get the per-stage timings and counters of the last parse().
+         * @return The stats, all zero unless the library is built with ADOCPP_PARSE_STATS.
+         */
+        [[nodiscard]] const ParseStats& parseStats() const noexcept;
+        /**
+         * @brief Get the pool of the tags of the level's events.
+         *
+         * Pass it to the constructors of the events added to the level, so that parse() matches their tags by id.
+         * fromJson() and clear() replace the pool.
+         * @return The pool.
+         */
+        [[nodiscard]] const std::shared_ptr<StringPool>& strings() const noexcept;
 
         [[nodiscard]] bool disableAnimateTrack() const;
         void disableAnimateTrack(bool disable);
@@ -411,31 +495,88 @@ namespace AdoCpp
     private:
         void parseTiles(size_t beginFloor = 0);
         void parseSetSpeed();
+        void parsePlanetOrbits();
         void parseDynamicEvents(std::vector<Event::DynamicEvent*>& dynamicEvents,
                                 std::vector<std::vector<Event::Modifiers::RepeatEvents*>>& vecRe);
         void parseAnimateTrack();
         void parseRepeatEvents(const std::vector<Event::DynamicEvent*>& dynamicEvents,
                                const std::vector<std::vector<Event::Modifiers::RepeatEvents*>>& vecRe);
         void parseMoveTrackData();
+        void addProcessedEvent(std::shared_ptr<Event::DynamicEvent> event, double beat, double seconds, size_t floor);
 
-        void updateTileColorInfo(const Event::Track::RecolorTrack* recolorTrack);
+        void resetTiles();
+        void updateAllTiles(double seconds);
+        void updateAnimatedTiles(double seconds);
+        void markTileChanged(size_t i);
+        void trackColorAnimation(size_t i);
+
+        void updateTileColorInfo(const Event::Track::RecolorTrack* recolorTrack, size_t floor, double seconds);
         void updateTileColor(double seconds, size_t i);
         void updateTilePos(double seconds, size_t i);
 
-        std::list<std::shared_ptr<Event::DynamicEvent>> m_processedDynamicEvents;
-        std::vector<std::shared_ptr<Event::GamePlay::SetSpeed>> m_setSpeeds;
-        // y = kx + b
-        // (x, y, k)
-        struct SpeedData
+        /**
+         * @brief A dynamic event at the time it takes effect. The repetitions of RepeatEvents share the event they
+         * repeat and only differ in the time and the floor.
+         */
+        struct ProcessedEvent
         {
+            std::shared_ptr<Event::DynamicEvent> event;
             double beat;
             double seconds;
-            double bpm;
-
             size_t floor;
-            double angleOffset;
         };
+        std::shared_ptr<StringPool> m_strings = std::make_shared<StringPool>();
+        std::vector<ProcessedEvent> m_processedDynamicEvents;
+        std::vector<std::shared_ptr<Event::GamePlay::SetSpeed>> m_setSpeeds;
         std::vector<SpeedData> m_speedData;
+        /**
+         * @brief The beats and the seconds of tiles[1..], packed for the floor lookups.
+         */
+        std::vector<double> m_tileBeats, m_tileSeconds;
+
+        /**
+         * @brief How the moving planet turns around a tile, so that its direction is linear in time. The pivot is
+         * read from the tile at each call, as the tiles move.
+         */
+        struct PlanetOrbit
+        {
+            Angle startAngle;    // at startSeconds
+            Angle velocity;      // per second
+            double startSeconds;
+            double direction;    // -1 clockwise, 1 counterclockwise
+            size_t speedIndex;   // of the last speed data of the tile
+        };
+        std::vector<PlanetOrbit> m_planetOrbits;
+
+        /**
+         * @brief When MoveTrack moves a tile. The overlapping ranges of a tile are merged, and the tile keeps its
+         * place outside of them.
+         */
+        struct TileAnimation
+        {
+            double beginSeconds;
+            double endSeconds;
+            size_t tile;
+        };
+        std::vector<TileAnimation> m_tileAnimations; // sorted by beginSeconds
+        std::vector<TileAnimation> m_activeTileAnimations;
+        size_t m_nextTileAnimation = 0;
+        size_t m_nextRecolor = 0; // the first event of m_processedDynamicEvents not applied by update()
+        std::vector<size_t> m_colorAnimatedTiles;
+        /**
+         * @brief The seconds of the last update(), or NaN if the next one must recompute every tile.
+         */
+        double m_updatedSeconds = std::numeric_limits<double>::quiet_NaN();
+        enum TileFlag : uint8_t
+        {
+            TileChanged = 1,       // in m_changedTiles
+            TileColorAnimated = 2, // its color depends on the time
+            TileInColorList = 4    // in m_colorAnimatedTiles
+        };
+        std::vector<uint8_t> m_tileFlags;
+        std::vector<size_t> m_changedTiles;
+
+        ParseStats m_parseStats;
 
         friend class Camera;
     };
@@ -0,0 +1,28 @@
+#include "ParseStats.h"
+
+namespace AdoCpp
+{
+    Json::Value ParseStats::intoJson() const
+    {
+        Json::Value val(Json::objectValue);
+        val["enabled"] = enabled;
+        val["totalMs"] = totalMs;
+        val["parseTilesMs"] = parseTilesMs;
+        val["parseSetSpeedMs"] = parseSetSpeedMs;
+        val["parsePlanetOrbitsMs"] = parsePlanetOrbitsMs;
+        val["parseDynamicEventsMs"] = parseDynamicEventsMs;
+        val["parseAnimateTrackMs"] = parseAnimateTrackMs;
+        val["parseRepeatEventsMs"] = parseRepeatEventsMs;
+        val["sortEventsMs"] = sortEventsMs;
+        val["parseMoveTrackDataMs"] = parseMoveTrackDataMs;
+        val["tiles"] = Json::UInt64(tiles);
+        val["events"] = Json::UInt64(events);
+        val["setSpeeds"] = Json::UInt64(setSpeeds);
+        val["dynamicEvents"] = Json::UInt64(dynamicEvents);
+        val["animateTrackEvents"] = Json::UInt64(animateTrackEvents);
+        val["repeatedEvents"] = Json::UInt64(repeatedEvents);
+        val["moveTrackRecords"] = Json::UInt64(moveTrackRecords);
+        val["allocations"] = Json::UInt64(allocations);
+        return val;
+    }
+} // namespace AdoCpp
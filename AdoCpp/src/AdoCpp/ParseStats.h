@@ -0,0 +1,101 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <json5cpp.h>
+
+namespace AdoCpp
+{
+    /**
+     * @brief What the last Level::parse() spent its time on and how much it generated.
+     *
+     * Only collected when the library is built with ADOCPP_PARSE_STATS (the CMake option of the same name).
+     * Otherwise the timers and counters compile to nothing and every field stays zero.
+     */
+    struct ParseStats
+    {
+#ifdef ADOCPP_PARSE_STATS
+        static constexpr bool enabled = true;
+#else
+        static constexpr bool enabled = false;
+#endif
+
+        /**
+         * @brief Wall-clock time of each stage in milliseconds.
+         */
+        double totalMs = 0;
+        double parseTilesMs = 0;
+        double parseSetSpeedMs = 0;
+        double parsePlanetOrbitsMs = 0;
+        double parseDynamicEventsMs = 0;
+        double parseAnimateTrackMs = 0;
+        double parseRepeatEventsMs = 0;
+        double sortEventsMs = 0;
+        double parseMoveTrackDataMs = 0;
+
+        size_t tiles = 0;
+        /**
+         * @brief The active events of the level.
+         */
+        size_t events = 0;
+        size_t setSpeeds = 0;
+        size_t dynamicEvents = 0;
+        /**
+         * @brief The MoveTracks generated for the track appear and disappear animations.
+         */
+        size_t animateTrackEvents = 0;
+        /**
+         * @brief The repetitions added by RepeatEvents. They share the event they repeat instead of cloning it.
+         */
+        size_t repeatedEvents = 0;
+        size_t moveTrackRecords = 0;
+        /**
+         * @brief The heap allocations made by the parse itself: generated events and the growth of the processed
+         * event list and of the tiles' moveTrackDatas. Allocations inside the standard library's sort are not
+         * counted.
+         */
+        size_t allocations = 0;
+
+        /**
+         * @brief Export the stats as json data, e.g. to log them.
+         * @return Json data.
+         */
+        [[nodiscard]] Json::Value intoJson() const;
+    };
+
+    /**
+     * @brief Adds the lifetime of the timer to a ParseStats field. Use ADOCPP_PARSE_TIMER instead.
+     */
+    class ScopedParseTimer
+    {
+    public:
+        explicit ScopedParseTimer(double& ms) : m_ms(ms), m_start(std::chrono::steady_clock::now()) {}
+        ScopedParseTimer(const ScopedParseTimer&) = delete;
+        ScopedParseTimer& operator=(const ScopedParseTimer&) = delete;
+        ~ScopedParseTimer()
+        {
+            m_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+    private:
+        double& m_ms;
+        std::chrono::steady_clock::time_point m_start;
+    };
+} // namespace AdoCpp
+
+#define ADOCPP_PARSE_STATS_CONCAT_(a, b) a##b
+#define ADOCPP_PARSE_STATS_CONCAT(a, b) ADOCPP_PARSE_STATS_CONCAT_(a, b)
+
+#ifdef ADOCPP_PARSE_STATS
+/**
+ * @brief Time the rest of the scope into stats.field.
+ */
+#define ADOCPP_PARSE_TIMER(stats, field)                                                                               \
+    const ::AdoCpp::ScopedParseTimer ADOCPP_PARSE_STATS_CONCAT(adocppParseTimer, __LINE__)((stats).field)
+/**
+ * @brief Add n to stats.field.
+ */
+#define ADOCPP_PARSE_COUNT(stats, field, n) ((stats).field += (n))
+#else
+#define ADOCPP_PARSE_TIMER(stats, field) static_cast<void>(0)
+#define ADOCPP_PARSE_COUNT(stats, field, n) static_cast<void>(0)
+#endif
@@ -0,0 +1,57 @@
+#include "StringPool.h"
+#include <algorithm>
+#include <cassert>
+
+namespace AdoCpp
+{
+    StringPool::Id StringPool::intern(const std::string_view str)
+    {
+        if (const auto it = m_ids.find(str); it != m_ids.end())
+            return it->second;
+        // The deque never moves its strings, so the key can view the stored string.
+        const std::string& stored = m_strings.emplace_back(str);
+        const auto id = static_cast<Id>(m_strings.size() - 1);
+        m_ids.emplace(stored, id);
+        return id;
+    }
+
+    std::optional<StringPool::Id> StringPool::find(const std::string_view str) const
+    {
+        if (const auto it = m_ids.find(str); it != m_ids.end())
+            return it->second;
+        return std::nullopt;
+    }
+
+    std::string_view StringPool::view(const Id id) const
+    {
+        assert(id < m_strings.size() && "The id is not in the pool");
+        return m_strings[id];
+    }
+
+    const StringPool::TagList& StringPool::internTags(const std::string_view str)
+    {
+        if (const auto it = m_tagListsByStr.find(str); it != m_tagListsByStr.end())
+            return *it->second;
+        // Split like std::getline with ' ', which drops a trailing empty tag.
+        TagList& list = m_tagLists.emplace_back();
+        for (size_t begin = 0; begin < str.size();)
+        {
+            const size_t end = std::min(str.find(' ', begin), str.size());
+            const std::string_view tag = str.substr(begin, end - begin);
+            list.str.append(list.ids.empty() ? "" : " ").append(tag);
+            list.ids.push_back(intern(tag));
+            begin = end + 1;
+        }
+        m_tagListsByStr.emplace(view(intern(str)), &list);
+        return list;
+    }
+
+    Tags::Tags(std::shared_ptr<StringPool> pool, const std::string_view str) : m_pool(std::move(pool))
+    {
+        if (str.empty())
+            return;
+        if (!m_pool)
+            m_pool = std::make_shared<StringPool>();
+        m_list = &m_pool->internTags(str);
+    }
+} // namespace AdoCpp
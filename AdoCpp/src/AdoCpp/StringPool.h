@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace AdoCpp
+{
+    /**
+     * @brief An append-only table of strings, each of which is stored once and referred to by a compact id.
+     *
+     * A level keeps one for the strings that repeat across its events, so that thousands of events with the same
+     * tags share them and compare them as integers. The views stay valid as long as the pool lives.
+     */
+    class StringPool
+    {
+    public:
+        using Id = uint32_t;
+
+        /**
+         * @brief A list of tags separated by spaces, split and interned once for all the events that have it.
+         */
+        struct TagList
+        {
+            /**
+             * @brief The tags joined by single spaces.
+             */
+            std::string str;
+            std::vector<Id> ids;
+        };
+
+        StringPool() = default;
+        StringPool(const StringPool&) = delete;
+        StringPool& operator=(const StringPool&) = delete;
+
+        /**
+         * @brief Get the id of a string, adding the string if it is new.
+         * @param str The string.
+         * @return The id of the string.
+         */
+        Id intern(std::string_view str);
+        /**
+         * @brief Get the id of a string without adding it.
+         * @param str The string.
+         * @return The id of the string, or nothing if the pool does not have it.
+         */
+        [[nodiscard]] std::optional<Id> find(std::string_view str) const;
+        /**
+         * @brief Get the string of an id.
+         * @param id The id.
+         * @return A view of the string.
+         */
+        [[nodiscard]] std::string_view view(Id id) const;
+        /**
+         * @brief Get the number of strings in the pool.
+         * @return The number of strings.
+         */
+        [[nodiscard]] size_t size() const noexcept { return m_strings.size(); }
+
+        /**
+         * @brief Split a list of tags separated by spaces and intern the tags.
+         * @param str The list of tags, e.g. the "eventTag" of an event.
+         * @return The interned list, shared by every call with the same str.
+         */
+        const TagList& internTags(std::string_view str);
+
+    private:
+        std::deque<std::string> m_strings;
+        std::unordered_map<std::string_view, Id> m_ids;
+        std::deque<TagList> m_tagLists;
+        std::unordered_map<std::string_view, const TagList*> m_tagListsByStr;
+    };
+
+    /**
+     * @brief The tags of an event, interned in the StringPool of its level.
+     *
+     * An event without tags holds nothing. Copies share the list, and the list keeps its pool alive.
+     */
+    class Tags
+    {
+    public:
+        Tags() = default;
+        /**
+         * @brief Split a list of tags separated by spaces and intern it in a pool.
+         * @param pool The pool, usually Level::strings(). A new pool is created for the tags if it is null.
+         * @param str The list of tags.
+         */
+        Tags(std::shared_ptr<StringPool> pool, std::string_view str);
+
+        [[nodiscard]] bool empty() const noexcept { return !m_list || m_list->ids.empty(); }
+        [[nodiscard]] size_t size() const noexcept { return m_list ? m_list->ids.size() : 0; }
+        /**
+         * @brief Get the id of a tag in the pool of the tags.
+         */
+        [[nodiscard]] StringPool::Id id(const size_t i) const { return m_list->ids[i]; }
+        [[nodiscard]] std::string_view operator[](const size_t i) const { return m_pool->view(m_list->ids[i]); }
+        /**
+         * @brief Get the tags joined by single spaces, as written in level data.
+         */
+        [[nodiscard]] std::string_view str() const noexcept { return m_list ? m_list->str : std::string_view(); }
+        [[nodiscard]] const std::shared_ptr<StringPool>& pool() const noexcept { return m_pool; }
+
+    private:
+        std::shared_ptr<StringPool> m_pool;
+        const StringPool::TagList* m_list = nullptr;
+    };
+} // namespace AdoCpp
@@ -13,7 +13,7 @@ namespace AdoCpp
     {
         Json::Value val(Json::arrayValue);
         val.append(index);
-        val.append(relativeTo);
+        val.append(relativeToTile2cstr(relativeTo));
         return val;
     }
     bool toBool(const Json::Value& data)
@@ -64,6 +64,10 @@ namespace AdoCpp
     {
         jsonValue[repeatEvents ? "tag" : "eventTag"] = tags2string(tags);
     }
+    void addTag(Json::Value& jsonValue, const Tags& tags, bool repeatEvents)
+    {
+        jsonValue[repeatEvents ? "tag" : "eventTag"] = std::string(tags.str());
+    }
     void autoRemoveDecimalPart(Json::Value& jsonValue, const char* name, const double value)
     {
         if (static_cast<int64_t>(value) == value)
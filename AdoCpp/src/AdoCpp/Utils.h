@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <json5cpp.h>
+#include "StringPool.h"
 
 namespace AdoCpp
 {
@@ -80,7 +81,7 @@ namespace AdoCpp
                 return angles[i];
         throw std::invalid_argument("Invalid path");
     }
-    constexpr char angle2path(const char angle)
+    constexpr char angle2path(const double angle)
     {
         for (size_t i = 0; i < std::size(angles); ++i)
             if (angle == angles[i])
@@ -178,8 +179,9 @@ namespace AdoCpp
     double includedAngle(double angleDeg, double nextAngleDeg);
 
     std::vector<std::string> cstr2tags(const char* str);
-    void tags2string(const std::vector<std::string>& tags, char* dest, rsize_t sizeInBytes);
+    std::string tags2string(const std::vector<std::string>& tags);
 
     void addTag(Json::Value& jsonValue, const std::vector<std::string>& tags, bool repeatEvents = false);
+    void addTag(Json::Value& jsonValue, const Tags& tags, bool repeatEvents = false);
     void autoRemoveDecimalPart(Json::Value& jsonValue, const char* name, double value);
 } // namespace AdoCpp
@@ -1,63 +1,349 @@
 #pragma once
 #include <SFML/Audio.hpp>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-inline std::filesystem::path addHitsound(std::filesystem::path path, const std::vector<AdoCpp::Tile>& tiles,
-                                         float* progress = nullptr)
+/**
+ * A hitsound to mix in, starting at an output frame.
+ */
+struct HitOnset
 {
-    if (progress)
-        *progress = -1;
-    sf::SoundBuffer origSb{path}, newSb{}, hitSb{"assets/sound/hit.wav"};
-    assert(hitSb.getChannelCount() == 2);
-    auto samples = new int16_t[origSb.getSampleCount()];
-    static constexpr short MAX = 32767, MIN = -32768;
-    // ReSharper disable CppFunctionalStyleCast
+    uint64_t frame;
+    float gain;
+};
+
+/**
+ * Converts hit.wav to the song's sample rate and channel layout once, so mixing is a plain multiply-add over
+ * contiguous floats.
+ */
+inline std::vector<float> resampleHitsound(const sf::SoundBuffer& hitSb, const unsigned sampleRate,
+                                           const unsigned channelCount)
+{
+    const unsigned hitChannelCount = hitSb.getChannelCount();
+    const uint64_t hitFrames = hitSb.getSampleCount() / hitChannelCount;
+    const double step = static_cast<double>(hitSb.getSampleRate()) / sampleRate;
+    const auto frames = static_cast<size_t>(static_cast<double>(hitFrames) / step);
+    std::vector<float> hit(frames * channelCount);
+    for (size_t i = 0; i < frames; i++)
+    {
+        const auto src = static_cast<size_t>(static_cast<double>(i) * step);
+        for (unsigned c = 0; c < channelCount; c++)
+            hit[i * channelCount + c] = hitSb.getSamples()[src * hitChannelCount + c % hitChannelCount];
+    }
+    return hit;
+}
+
+/**
+ * The hitsounds of the tiles, sorted by frame. Midspins are skipped and use the volume of the tile before them;
+ * tiles whose hitsound is None stay silent.
+ */
+inline std::vector<HitOnset> collectHitOnsets(const std::vector<AdoCpp::Tile>& tiles, const unsigned sampleRate)
+{
+    std::vector<HitOnset> onsets;
     for (size_t k = 1 /* tile[0].beat = -INF */; k < tiles.size(); k++)
     {
-        if (tiles[k].angle.deg() == 999)
+        if (tiles[k].angle.deg() == 999 || tiles[k].seconds < 0)
             continue;
         const bool midspin = k != tiles.size() - 1 && tiles[k + 1].angle.deg() == 999;
-        const float hitVolume =
-            4.f * float(midspin ? tiles[k].midspinHitsoundVolume : tiles[k].hitsoundVolume) /
-            100;
-        float f = 1, val;
-        for (size_t i = 0; i < hitSb.getSampleCount() / 4; i++)
+        if ((midspin ? tiles[k].midspinHitsound : tiles[k].hitsound) == AdoCpp::Hitsound::None)
+            continue;
+        // The music is mixed at half volume, so the hitsound gets twice its volume to keep the balance.
+        const float gain =
+            2.f * static_cast<float>(midspin ? tiles[k].midspinHitsoundVolume : tiles[k].hitsoundVolume) / 100;
+        onsets.push_back({static_cast<uint64_t>(tiles[k].seconds * sampleRate), gain});
+    }
+    std::ranges::stable_sort(onsets, {}, &HitOnset::frame);
+    return onsets;
+}
+
+/**
+ * Mixes one chunk: half the music plus every hitsound overlapping [frameStart, frameStart + frames).
+ * The overlapping onsets are found by binary search, so a chunk costs the same wherever it is in the song.
+ */
+inline void mixHitsoundChunk(const int16_t* music, float* out, const uint64_t frameStart, const uint64_t frames,
+                             const unsigned channelCount, const std::vector<HitOnset>& onsets,
+                             const std::vector<float>& hit)
+{
+    const uint64_t sampleCount = frames * channelCount;
+    for (uint64_t i = 0; i < sampleCount; i++)
+        out[i] = 0.5f * static_cast<float>(music[i]);
+    const uint64_t hitFrames = hit.size() / channelCount, frameEnd = frameStart + frames;
+    const uint64_t firstOverlapping = frameStart >= hitFrames ? frameStart - hitFrames + 1 : 0;
+    for (auto it = std::ranges::lower_bound(onsets, firstOverlapping, {}, &HitOnset::frame);
+         it != onsets.end() && it->frame < frameEnd; ++it)
+    {
+        const uint64_t begin = std::max(it->frame, frameStart), end = std::min(it->frame + hitFrames, frameEnd);
+        const float* src = hit.data() + (begin - it->frame) * channelCount;
+        float* dst = out + (begin - frameStart) * channelCount;
+        const float gain = it->gain;
+        for (uint64_t i = 0; i < (end - begin) * channelCount; i++)
+            dst[i] += src[i] * gain;
+    }
+}
+
+/**
+ * A look-ahead peak limiter from float to int16. The gain starts ramping down a short window before a peak that
+ * would clip, so the peak lands exactly at full scale, and then recovers smoothly.
+ */
+class LookAheadLimiter
+{
+public:
+    LookAheadLimiter(const unsigned channelCount, const unsigned sampleRate) :
+        m_channelCount(channelCount), m_lookAhead(std::max(1u, sampleRate / 500)),
+        m_release(1 - std::exp(-1 / (0.05f * static_cast<float>(sampleRate))))
+    {
+    }
+    void push(const std::vector<float>& samples) { m_pending.insert(m_pending.end(), samples.begin(), samples.end()); }
+    /**
+     * Limits the frames whose look-ahead window is complete into out. With flush, all remaining frames are output.
+     */
+    void pull(std::vector<int16_t>& out, const bool flush)
+    {
+        static constexpr float limit = 32767;
+        const size_t frames = m_pending.size() / m_channelCount;
+        const size_t ready = flush ? frames : frames > m_lookAhead ? frames - m_lookAhead : 0;
+        m_required.resize(frames);
+        for (size_t f = 0; f < frames; f++)
+        {
+            float peak = 0;
+            for (unsigned c = 0; c < m_channelCount; c++)
+                peak = std::max(peak, std::abs(m_pending[f * m_channelCount + c]));
+            m_required[f] = peak > limit ? limit / peak : 1;
+        }
+        out.resize(ready * m_channelCount);
+        std::deque<size_t> loud; // The frames ahead that need a gain below 1.
+        for (size_t f = 0, next = 0; f < ready; f++)
         {
-            for (size_t j = 0; j < origSb.getChannelCount(); j++)
+            for (; next < frames && next <= f + m_lookAhead; next++)
+                if (m_required[next] < 1)
+                    loud.push_back(next);
+            while (!loud.empty() && loud.front() < f)
+                loud.pop_front();
+            float target = 1;
+            for (const size_t k : loud)
+                target = std::min(target, m_required[k] + (1 - m_required[k]) * static_cast<float>(k - f) /
+                                                              static_cast<float>(m_lookAhead + 1));
+            m_gain = target < m_gain ? target : m_gain + (target - m_gain) * m_release;
+            for (unsigned c = 0; c < m_channelCount; c++)
             {
-                const size_t idx =
-                    (size_t(tiles[k].seconds * origSb.getSampleRate()) + i) * origSb.getChannelCount() + j;
-                const size_t hitIdx = i * 4 + j % 4;
-                if (idx >= origSb.getSampleCount())
-                    break;
-                val = (samples[idx] + hitSb.getSamples()[hitIdx] * hitVolume) * f;
-                if (val > MAX)
-                    f = MAX / val, val = MAX;
-                if (val < MIN)
-                    f = MIN / val, val = MIN;
-                if (f < 1)
-                    f += (1 - f) / 32;
-                samples[idx] = short(val);
+                const float val = std::round(m_pending[f * m_channelCount + c] * m_gain);
+                out[f * m_channelCount + c] = static_cast<int16_t>(std::clamp(val, -32768.f, 32767.f));
             }
         }
-        if (progress)
-            *progress = float(k) / float(tiles.size());
+        m_pending.erase(m_pending.begin(), m_pending.begin() + static_cast<ptrdiff_t>(ready * m_channelCount));
+    }
+
+private:
+    unsigned m_channelCount;
+    size_t m_lookAhead;
+    float m_release;
+    float m_gain = 1;
+    std::vector<float> m_pending, m_required;
+};
+
+/**
+ * A fixed set of worker threads fed through a bounded queue. submit() blocks while the queue is full, so a producer
+ * cannot run further ahead of the workers than the queue holds.
+ */
+class WorkerPool
+{
+public:
+    WorkerPool(const unsigned workerCount, const size_t queueCapacity) : m_capacity(std::max<size_t>(1, queueCapacity))
+    {
+        for (unsigned i = 0; i < std::max(1u, workerCount); i++)
+            m_workers.emplace_back(&WorkerPool::work, this);
     }
-    for (size_t i = 0; i < origSb.getSampleCount(); i++)
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    /**
+     * Runs the queued tasks to the end before joining the workers.
+     */
+    ~WorkerPool()
     {
-        samples[i] = samples[i] / 2 + origSb.getSamples()[i] / 2;
+        {
+            std::scoped_lock lock(m_mutex);
+            m_stop = true;
+        }
+        m_notEmpty.notify_all();
+        for (auto& worker : m_workers)
+            worker.join();
     }
-    // ReSharper restore CppFunctionalStyleCast
+    void submit(std::function<void()> task)
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_notFull.wait(lock, [this] { return m_queue.size() < m_capacity; });
+            m_queue.push_back(std::move(task));
+        }
+        m_notEmpty.notify_one();
+    }
+
+private:
+    void work()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(m_mutex);
+                m_notEmpty.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+                if (m_queue.empty())
+                    return;
+                task = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            m_notFull.notify_one();
+            task();
+        }
+    }
+
+    size_t m_capacity;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty, m_notFull;
+    std::deque<std::function<void()>> m_queue;
+    bool m_stop{};
+    std::vector<std::thread> m_workers;
+};
+
+/**
+ * Writes a copy of the music with a hitsound on every tile, next to the original file.
+ *
+ * The music is streamed in chunks through a pipeline: this thread decodes the chunks, a WorkerPool mixes them,
+ * and a writer thread limits them in order and appends them to the output file. The stages overlap, and only a
+ * fixed number of chunks is in flight, so memory use does not grow with the song length.
+ * @param path The music file.
+ * @param tiles The parsed tiles of the level.
+ * @param progress -1 while loading, then the fraction of the song that has been written.
+ * @return The path of the new file.
+ */
+inline std::filesystem::path addHitsound(std::filesystem::path path, const std::vector<AdoCpp::Tile>& tiles,
+                                         float* progress = nullptr)
+{
     if (progress)
-        *progress = 2;
-    if (!newSb.loadFromSamples(samples, origSb.getSampleCount(), origSb.getChannelCount(), origSb.getSampleRate(),
-                               origSb.getChannelMap()))
+        *progress = -1;
+    sf::InputSoundFile music;
+    if (!music.openFromFile(path))
         throw std::runtime_error("Failed to load sound.");
+    const sf::SoundBuffer hitSb{"assets/sound/hit.wav"};
+    const unsigned channelCount = music.getChannelCount(), sampleRate = music.getSampleRate();
+    const std::vector<float> hit = resampleHitsound(hitSb, sampleRate, channelCount);
+    const std::vector<HitOnset> onsets = collectHitOnsets(tiles, sampleRate);
+
     std::string ext = path.extension().string();
     if (ext == ".mp3")
         ext = ".wav";
     path.replace_extension().concat("-hitsound").concat(ext);
-    if (!newSb.saveToFile(path))
+    sf::OutputSoundFile output;
+    if (!output.openFromFile(path, sampleRate, channelCount, music.getChannelMap()))
         throw std::runtime_error("Failed to save sound.");
-    delete[] samples;
+
+    static constexpr uint64_t chunkFrames = 1 << 16;
+    const unsigned workerCount = std::max(1u, std::thread::hardware_concurrency());
+    const uint64_t totalFrames = music.getSampleCount() / channelCount;
+    // Chunk k uses slot k % slotCount, which is free again once the writer has written chunk k - slotCount.
+    struct Chunk
+    {
+        std::vector<int16_t> input;
+        std::vector<float> mixed;
+        bool ready{};
+    };
+    const size_t slotCount = 2 * static_cast<size_t>(workerCount) + 2;
+    std::vector<Chunk> chunks(slotCount);
+    std::mutex mutex;
+    std::condition_variable condition;
+    uint64_t submitted = 0, written = 0;
+    bool endOfMusic = false;
+
+    std::thread writer(
+        [&]
+        {
+            LookAheadLimiter limiter(channelCount, sampleRate);
+            std::vector<int16_t> limited;
+            uint64_t writtenFrames = 0;
+            for (uint64_t k = 0;; k++)
+            {
+                Chunk* chunk;
+                {
+                    std::unique_lock lock(mutex);
+                    condition.wait(lock, [&] { return k < submitted ? chunks[k % slotCount].ready : endOfMusic; });
+                    if (k >= submitted)
+                        break;
+                    chunk = &chunks[k % slotCount];
+                }
+                limiter.push(chunk->mixed);
+                limiter.pull(limited, false);
+                output.write(limited.data(), limited.size());
+                writtenFrames += chunk->mixed.size() / channelCount;
+                {
+                    std::scoped_lock lock(mutex);
+                    chunk->ready = false, written = k + 1;
+                }
+                condition.notify_all();
+                if (progress)
+                    *progress =
+                        static_cast<float>(writtenFrames) / static_cast<float>(std::max<uint64_t>(1, totalFrames));
+            }
+            limiter.pull(limited, true);
+            output.write(limited.data(), limited.size());
+        });
+    // Ends and joins the writer however this function is left, so a throw in the loop below (a failed read or
+    // allocation) ends the output at the last submitted chunk instead of destroying a joinable thread.
+    struct WriterJoin
+    {
+        std::thread& writer;
+        std::mutex& mutex;
+        std::condition_variable& condition;
+        bool& endOfMusic;
+        ~WriterJoin()
+        {
+            {
+                std::scoped_lock lock(mutex);
+                endOfMusic = true;
+            }
+            condition.notify_all();
+            writer.join();
+        }
+    } writerJoin{writer, mutex, condition, endOfMusic};
+
+    {
+        WorkerPool pool(workerCount, slotCount);
+        for (uint64_t k = 0, frame = 0; frame < totalFrames; k++)
+        {
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [&] { return k - written < slotCount; });
+            }
+            Chunk& chunk = chunks[k % slotCount];
+            chunk.input.resize(chunkFrames * channelCount);
+            const uint64_t read = music.read(chunk.input.data(), chunk.input.size());
+            if (read == 0)
+                break;
+            chunk.input.resize(read), chunk.mixed.resize(read);
+            pool.submit(
+                [&, frameStart = frame]
+                {
+                    mixHitsoundChunk(chunk.input.data(), chunk.mixed.data(), frameStart,
+                                     chunk.input.size() / channelCount, channelCount, onsets, hit);
+                    {
+                        std::scoped_lock lock(mutex);
+                        chunk.ready = true;
+                    }
+                    condition.notify_all();
+                });
+            // Counted only once submitted, so the writer never waits for a chunk that a throw kept from the pool.
+            {
+                std::scoped_lock lock(mutex);
+                submitted = k + 1;
+            }
+            condition.notify_all();
+            frame += read / channelCount;
+        }
+    }
     return path;
 }
@@ -0,0 +1,169 @@
+#include "BeatDetection.h"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <numeric>
+#include <thread>
+#include "Fft.h"
+
+namespace
+{
+    /**
+     * The spectral flux of the windows [begin, end). Window i is centred on sample frame i * hopSize.
+     */
+    void spectralFlux(const int16_t* samples, const uint64_t frameCount, const unsigned channelCount,
+                      const Fft& fft, const int64_t begin, const int64_t end, float* flux)
+    {
+        constexpr unsigned n = BeatAnalysis::windowSize, bins = n / 2 + 1;
+        const std::vector<float> window = hannWindow(n);
+        std::vector<std::complex<float>> buffer(n);
+        std::vector<float> previous(bins), current(bins);
+        const float scale = 1.f / (32768.f * static_cast<float>(channelCount));
+        const auto spectrum = [&](const int64_t index, std::vector<float>& magnitudes)
+        {
+            const int64_t start = index * BeatAnalysis::hopSize - n / 2;
+            for (unsigned i = 0; i < n; i++)
+            {
+                const int64_t frame = start + i;
+                float sum = 0;
+                if (frame >= 0 && static_cast<uint64_t>(frame) < frameCount)
+                    for (unsigned c = 0; c < channelCount; c++)
+                        sum += samples[frame * channelCount + c];
+                buffer[i] = sum * scale * window[i];
+            }
+            fft.transform(buffer);
+            // Log compression keeps quiet onsets from being buried by loud sustained notes.
+            for (unsigned k = 0; k < bins; k++)
+                magnitudes[k] = std::log1p(100 * std::abs(buffer[k]));
+        };
+        spectrum(begin - 1, previous);
+        for (int64_t i = begin; i < end; i++)
+        {
+            spectrum(i, current);
+            float sum = 0;
+            for (unsigned k = 0; k < bins; k++)
+                sum += std::max(0.f, current[k] - previous[k]);
+            flux[i] = sum;
+            std::swap(previous, current);
+        }
+    }
+
+    /**
+     * Removes the local mean from the flux and keeps the positive part, so only sudden changes remain.
+     */
+    std::vector<float> onsetEnvelope(const std::vector<float>& flux, const size_t radius)
+    {
+        std::vector<double> prefix(flux.size() + 1);
+        std::inclusive_scan(flux.begin(), flux.end(), prefix.begin() + 1, std::plus<double>());
+        std::vector<float> envelope(flux.size());
+        for (size_t i = 0; i < flux.size(); i++)
+        {
+            const size_t lo = i >= radius ? i - radius : 0, hi = std::min(flux.size(), i + radius + 1);
+            const double mean = (prefix[hi] - prefix[lo]) / static_cast<double>(hi - lo);
+            envelope[i] = std::max(0.f, flux[i] - static_cast<float>(mean));
+        }
+        return envelope;
+    }
+
+    float sampleEnvelope(const std::vector<float>& envelope, const double index)
+    {
+        const auto i = static_cast<size_t>(index);
+        if (i + 1 >= envelope.size())
+            return i < envelope.size() ? envelope[i] : 0;
+        const auto t = static_cast<float>(index - static_cast<double>(i));
+        return envelope[i] * (1 - t) + envelope[i + 1] * t;
+    }
+} // namespace
+
+std::optional<double> BeatAnalysis::nearestOnset(const double seconds, const double tolerance) const
+{
+    const auto it = std::ranges::lower_bound(onsets, seconds);
+    std::optional<double> nearest;
+    if (it != onsets.end() && *it - seconds <= tolerance)
+        nearest = *it;
+    if (it != onsets.begin() && seconds - *(it - 1) <= tolerance &&
+        (!nearest || seconds - *(it - 1) < *nearest - seconds))
+        nearest = *(it - 1);
+    return nearest;
+}
+
+BeatAnalysis analyseBeats(const int16_t* samples, const uint64_t frameCount, const unsigned channelCount,
+                          const unsigned sampleRate)
+{
+    BeatAnalysis analysis;
+    const double fps = static_cast<double>(sampleRate) / BeatAnalysis::hopSize; // windows per second
+    const auto windowCount = static_cast<int64_t>(frameCount / BeatAnalysis::hopSize + 1);
+    const auto minLag = static_cast<size_t>(std::floor(60 * fps / BeatAnalysis::maxBpm)),
+               maxLag = static_cast<size_t>(std::ceil(60 * fps / BeatAnalysis::minBpm));
+    if (channelCount == 0 || static_cast<size_t>(windowCount) <= maxLag + 2)
+        return analysis;
+
+    const Fft fft(BeatAnalysis::windowSize);
+    std::vector<float> flux(windowCount);
+    const auto workerCount = static_cast<int64_t>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::future<void>> tasks;
+    for (int64_t w = 0; w < workerCount; w++)
+    {
+        const int64_t begin = windowCount * w / workerCount, end = windowCount * (w + 1) / workerCount;
+        tasks.push_back(std::async(std::launch::async, spectralFlux, samples, frameCount, channelCount,
+                                   std::cref(fft), begin, end, flux.data()));
+    }
+    for (auto& task : tasks)
+        task.get();
+    flux[0] = 0; // The first window is compared against silence.
+
+    const std::vector<float> envelope = onsetEnvelope(flux, static_cast<size_t>(0.1 * fps));
+    const double mean = std::accumulate(envelope.begin(), envelope.end(), 0.0) / static_cast<double>(windowCount);
+
+    // Onsets: local maxima over +-30 ms that stand out from the average, at least 50 ms apart.
+    const auto peakRadius = std::max<size_t>(1, static_cast<size_t>(0.03 * fps));
+    for (size_t i = 0; i < envelope.size(); i++)
+    {
+        if (envelope[i] <= 1.5 * mean)
+            continue;
+        const size_t lo = i >= peakRadius ? i - peakRadius : 0, hi = std::min(envelope.size(), i + peakRadius + 1);
+        if (std::max_element(envelope.begin() + lo, envelope.begin() + hi) != envelope.begin() + i)
+            continue;
+        const double seconds = static_cast<double>(i) / fps;
+        if (analysis.onsets.empty() || seconds - analysis.onsets.back() >= 0.05)
+            analysis.onsets.push_back(seconds);
+    }
+
+    // Tempo: the autocorrelation of the envelope, weighted towards 120 BPM to settle octave errors.
+    std::vector<double> correlation(maxLag + 2);
+    for (size_t lag = minLag; lag <= maxLag + 1; lag++)
+    {
+        double sum = 0;
+        for (size_t i = 0; i + lag < envelope.size(); i++)
+            sum += static_cast<double>(envelope[i]) * envelope[i + lag];
+        const double octaves = std::log2(60 * fps / static_cast<double>(lag) / 120);
+        correlation[lag] = sum / static_cast<double>(envelope.size() - lag) * std::exp(-0.5 * octaves * octaves);
+    }
+    size_t bestLag = minLag;
+    for (size_t lag = minLag; lag <= maxLag; lag++)
+        if (correlation[lag] > correlation[bestLag])
+            bestLag = lag;
+    // Period and offset: the beat grid near the best lag that collects the most onset energy per beat. Over a
+    // whole song, this pins the period down far more precisely than the integer lag.
+    double period = static_cast<double>(bestLag), bestPhase = 0, bestScore = -1;
+    for (double candidate = static_cast<double>(bestLag) - 1; candidate <= static_cast<double>(bestLag) + 1;
+         candidate += 0.005)
+    {
+        for (double phase = 0; phase < candidate; phase += 0.25)
+        {
+            double score = 0;
+            size_t count = 0;
+            for (double index = phase; index < static_cast<double>(envelope.size()); index += candidate, count++)
+                score += sampleEnvelope(envelope, index);
+            score /= static_cast<double>(count);
+            if (score > bestScore)
+                bestScore = score, period = candidate, bestPhase = phase;
+        }
+    }
+    analysis.bpm = 60 * fps / period;
+    analysis.offset = bestPhase / fps * 1000;
+    const double duration = static_cast<double>(frameCount) / sampleRate;
+    for (double seconds = bestPhase / fps; seconds < duration; seconds += period / fps)
+        analysis.beats.push_back(seconds);
+    return analysis;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/**
+ * The onsets and the beat grid of a song, found by spectral flux onset detection.
+ *
+ * The song is cut into overlapping windows, and every window is Fourier transformed. A window's flux is how
+ * much louder its log-magnitude spectrum got since the previous window. Peaks of the flux are the onsets. The
+ * tempo is the lag where the flux correlates best with itself, and the offset is the phase of the beat grid that
+ * covers the most flux.
+ */
+struct BeatAnalysis
+{
+    static constexpr unsigned windowSize = 2048, hopSize = 512;
+    static constexpr double minBpm = 60, maxBpm = 240;
+
+    double bpm{};
+    /**
+     * The first beat at or after the start of the song in milliseconds, comparable to Settings::offset.
+     */
+    double offset{};
+    /**
+     * The onsets in seconds, sorted.
+     */
+    std::vector<double> onsets;
+    /**
+     * The beat grid given by bpm and offset in seconds, up to the end of the song.
+     */
+    std::vector<double> beats;
+
+    /**
+     * The onset closest to a time, e.g. Tile::seconds, if one is within the tolerance.
+     */
+    [[nodiscard]] std::optional<double> nearestOnset(double seconds, double tolerance) const;
+};
+
+/**
+ * Analyses interleaved int16 samples. The windows are transformed in parallel on all hardware threads.
+ */
+BeatAnalysis analyseBeats(const int16_t* samples, uint64_t frameCount, unsigned channelCount, unsigned sampleRate);
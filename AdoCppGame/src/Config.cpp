@@ -23,6 +23,8 @@ void Config::load()
     blockKeyboardChatter = doc["blockKeyboardChatter"].asBool();
     hidePerfects = doc["hidePerfects"].asBool();
     syncWithMusic = doc["syncWithMusic"].asBool();
+    if (doc.isMember("liveHitsound"))
+        liveHitsound = doc["liveHitsound"].asBool();
     disableAnimationTrack = doc["disableAnimationTrack"].asBool();
     rainSpeed = sf::seconds(doc["rainSpeed"].asFloat());
     rainLength = doc["rainLength"].asFloat();
@@ -49,6 +51,7 @@ void Config::save()
     doc["blockKeyboardChatter"] = blockKeyboardChatter;
     doc["hidePerfects"] = hidePerfects;
     doc["syncWithMusic"] = syncWithMusic;
+    doc["liveHitsound"] = liveHitsound;
     doc["disableAnimationTrack"] = disableAnimationTrack;
     doc["rainSpeed"] = rainSpeed.asSeconds();
     doc["rainLength"] = rainLength;
@@ -9,6 +9,7 @@ struct Config
     bool blockKeyboardChatter = true;
     bool hidePerfects = true;
     bool syncWithMusic = false;
+    bool liveHitsound = true;
     bool disableAnimationTrack = false;
     sf::Time rainSpeed = sf::seconds(0.4f);
     float rainLength = 240.f;
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <vector>
+
+/**
+ * An in-place iterative radix-2 FFT whose twiddles and bit reversal table are built once per size.
+ */
+class Fft
+{
+public:
+    explicit Fft(const unsigned size) : m_size(size), m_twiddles(size / 2), m_reversed(size)
+    {
+        for (unsigned i = 0; i < size / 2; i++)
+            m_twiddles[i] =
+                std::polar(1.f, -2 * std::numbers::pi_v<float> * static_cast<float>(i) / static_cast<float>(size));
+        const int bits = std::countr_zero(size);
+        for (unsigned i = 0; i < size; i++)
+            for (int b = 0; b < bits; b++)
+                m_reversed[i] |= (i >> b & 1) << (bits - 1 - b);
+    }
+    [[nodiscard]] unsigned size() const { return m_size; }
+    void transform(std::vector<std::complex<float>>& data) const
+    {
+        for (unsigned i = 0; i < m_size; i++)
+            if (i < m_reversed[i])
+                std::swap(data[i], data[m_reversed[i]]);
+        for (unsigned half = 1, stride = m_size / 2; half < m_size; half *= 2, stride /= 2)
+            for (unsigned start = 0; start < m_size; start += half * 2)
+                for (unsigned k = 0; k < half; k++)
+                {
+                    const std::complex<float> odd = data[start + k + half] * m_twiddles[k * stride];
+                    data[start + k + half] = data[start + k] - odd;
+                    data[start + k] += odd;
+                }
+    }
+
+private:
+    unsigned m_size;
+    std::vector<std::complex<float>> m_twiddles;
+    std::vector<unsigned> m_reversed;
+};
+
+/**
+ * A periodic Hann window of the given size.
+ */
+inline std::vector<float> hannWindow(const unsigned size)
+{
+    std::vector<float> window(size);
+    for (unsigned i = 0; i < size; i++)
+        window[i] =
+            0.5f - 0.5f * std::cos(2 * std::numbers::pi_v<float> * static_cast<float>(i) / static_cast<float>(size));
+    return window;
+}
@@ -5,14 +5,19 @@
 
 #include <IconsFontAwesome6.h>
 #include <State/Charting.h>
+#include <State/Playing.h>
+#include <cassert>
+#include <future>
 #include <implot.h>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include "Game.h"
+#include "Loading.h"
 #include "State.h"
 
 Game::Game() :
-    fps(), planetRadiusPx(50), arrFps(), avgFps(), minFps(), maxFps(), tileSystem(level),
-    autoplay(false), fullscreen(false)
+    planetRadiusPx(50), showProfiler(false), tileSystem(level), autoplay(false), fullscreen(false)
 {
 #ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
@@ -66,12 +71,39 @@ Game::Game() :
 
     ImPlot::CreateContext();
 
+    hitsoundStream.emplace();
     level.defaultLevel();
     changeState(StateCharting::instance());
 }
+Game::Game(HeadlessOptions l_headless) :
+    planetRadiusPx(50), showProfiler(false), tileSystem(level), autoplay(true), fullscreen(false),
+    headless(std::move(l_headless))
+{
+    setlocale(LC_ALL, ".UTF-8");
+
+    config.load();
+
+    settings.antiAliasingLevel = 8;
+    windowSize = headless->size;
+    if (headless->renderFrames && !renderTexture.resize(windowSize, settings))
+        throw std::runtime_error("Failed to create the offscreen render texture.");
+    font = sf::Font("assets/font/Maplestory OTF Bold.otf");
+
+    // No music is loaded, so StatePlaying follows the fixed timestep only.
+    levelPath = headless->levelPath;
+    level.fromFile(levelPath);
+    level.parse();
+    level.update();
+    tileSystem.parse();
+    tileSystem.update();
+    camera.init(level);
+    changeState(StatePlaying::instance());
+}
 Game::~Game()
 {
-    config.save();
+    LoadThreads::joinAll();
+    if (!headless)
+        config.save();
 }
 
 void Game::run()
@@ -79,17 +111,102 @@ void Game::run()
     while (true)
     {
         deltaTime = deltaClock.restart();
-        calcFps();
-        handleEvent();
+        profiler.beginFrame();
+        {
+            const ProfileZone zone(profiler, Profiler::Zone::HandleEvent);
+            handleEvent();
+        }
         if (!window.isOpen())
             break;
         update();
         render();
+        profiler.endFrame();
     }
     ImPlot::DestroyContext();
     ImGui::SFML::Shutdown();
 }
 
+bool Game::runHeadless()
+{
+    assert(headless && "Game::runHeadless requires the headless constructor");
+    if (headless->renderFrames)
+        std::filesystem::create_directories(headless->outputDir);
+    deltaTime = sf::seconds(1.f / static_cast<float>(headless->framerate));
+
+    const char* const verb = headless->renderFrames ? "Rendered " : "Simulated ";
+    const sf::Clock totalClock;
+    sf::Clock throughputClock;
+    size_t frame = 0, framesSinceReport = 0;
+    std::future<bool> pendingFrame;
+    const auto waitPendingFrame = [&pendingFrame]
+    {
+        if (pendingFrame.valid() && !pendingFrame.get())
+            throw std::runtime_error("Failed to write a frame to the output directory.");
+    };
+    while (!StatePlaying::instance()->finished())
+    {
+        profiler.beginFrame();
+        {
+            const ProfileZone zone(profiler, Profiler::Zone::StateUpdate);
+            states.back()->update();
+        }
+        frame++, framesSinceReport++;
+        if (headless->renderFrames)
+        {
+            {
+                const ProfileZone zone(profiler, Profiler::Zone::StateRender);
+                renderTexture.clear(sf::Color(20, 20, 20));
+                states.back()->render();
+            }
+            {
+                const ProfileZone zone(profiler, Profiler::Zone::Display);
+                renderTexture.display();
+            }
+
+            // The previous frame is encoded on another thread while this one is rendered.
+            std::ostringstream filename;
+            filename << std::setw(6) << std::setfill('0') << frame - 1 << headless->extension;
+            sf::Image image = renderTexture.getTexture().copyToImage();
+            waitPendingFrame();
+            pendingFrame = std::async(std::launch::async,
+                                      [image = std::move(image), path = headless->outputDir / filename.str()]
+                                      { return image.saveToFile(path); });
+        }
+        profiler.endFrame();
+
+        if (throughputClock.getElapsedTime() >= sf::seconds(1))
+        {
+            const float fps = static_cast<float>(framesSinceReport) / throughputClock.restart().asSeconds();
+            framesSinceReport = 0;
+            std::cout << verb << frame << " frames, " << fps << " fps\n";
+        }
+    }
+    waitPendingFrame();
+    bool succeeded = true;
+    if (!headless->tracePath.empty())
+    {
+        if (profiler.exportChromeTrace(headless->tracePath))
+            std::cout << "Wrote the trace of the last frames to " << headless->tracePath.string() << '\n';
+        else
+        {
+            std::cerr << "Error: Failed to write the trace to " << headless->tracePath.string() << '\n';
+            succeeded = false;
+        }
+    }
+    const float elapsed = totalClock.getElapsedTime().asSeconds(),
+                simulated = static_cast<float>(frame) * deltaTime.asSeconds();
+    std::cout << verb << frame << " frames in " << elapsed << " s, "
+              << (elapsed > 0 ? static_cast<float>(frame) / elapsed : 0.f) << " fps, "
+              << (elapsed > 0 ? simulated / elapsed : 0.f) << "x real time\n";
+    const auto& hitCounts = StatePlaying::instance()->getHitCounts();
+    using enum AdoCpp::HitMargin;
+    std::cout << "Judgements: " << hitCounts[static_cast<int>(TooEarly)] << ' '
+              << hitCounts[static_cast<int>(VeryEarly)] << ' ' << hitCounts[static_cast<int>(EarlyPerfect)] << ' '
+              << hitCounts[static_cast<int>(Perfect)] << ' ' << hitCounts[static_cast<int>(LatePerfect)] << ' '
+              << hitCounts[static_cast<int>(VeryLate)] << ' ' << hitCounts[static_cast<int>(TooLate)] << '\n';
+    return succeeded;
+}
+
 void Game::changeState(State* state)
 {
     if (!states.empty())
@@ -130,8 +247,12 @@ void Game::handleEvent()
         if (const auto resized = event->getIf<sf::Event::Resized>())
             windowSize = resized->size;
         if (const auto keyPressed = event->getIf<sf::Event::KeyPressed>())
+        {
             if (keyPressed->code == F11)
                 fullscreen = !fullscreen, createWindow();
+            else if (keyPressed->code == F3)
+                showProfiler = !showProfiler;
+        }
         ImGui::SFML::ProcessEvent(window, *event);
         states.back()->handleEvent(*event);
     }
@@ -139,15 +260,28 @@ void Game::handleEvent()
 
 void Game::update()
 {
-    ImGui::SFML::Update(window, deltaTime);
+    {
+        const ProfileZone zone(profiler, Profiler::Zone::ImGuiUpdate);
+        ImGui::SFML::Update(window, deltaTime);
+    }
+    const ProfileZone zone(profiler, Profiler::Zone::StateUpdate);
     states.back()->update();
 }
 
 void Game::render()
 {
-    window.clear(sf::Color(20, 20, 20));
-    states.back()->render();
-    ImGui::SFML::Render(window);
+    {
+        const ProfileZone zone(profiler, Profiler::Zone::StateRender);
+        window.clear(sf::Color(20, 20, 20));
+        states.back()->render();
+    }
+    if (showProfiler)
+        profiler.drawOverlay(&showProfiler);
+    {
+        const ProfileZone zone(profiler, Profiler::Zone::ImGuiRender);
+        ImGui::SFML::Render(window);
+    }
+    const ProfileZone zone(profiler, Profiler::Zone::Display);
     window.display();
 }
 
@@ -161,18 +295,3 @@ void Game::createWindow()
         windowSize = {800, 600},
         window.create(sf::VideoMode(windowSize), title, sf::Style::Default, sf::State::Windowed, settings);
 }
-void Game::calcFps()
-{
-    fps = 1 / deltaTime.asSeconds(), avgFps = 0, minFps = std::numeric_limits<float>::max(), maxFps = 0;
-    for (size_t i = 0; i < arrFps.size(); i++)
-    {
-        if (i != arrFps.size() - 1)
-            arrFps[i] = arrFps[i + 1];
-        else
-            arrFps[i] = fps;
-        avgFps += arrFps[i];
-        minFps = std::min(minFps, arrFps[i]);
-        maxFps = std::max(maxFps, arrFps[i]);
-    }
-    avgFps /= static_cast<float>(arrFps.size());
-}
@@ -7,18 +7,41 @@
 #include <AdoCpp.h>
 
 #include "Config.h"
+#include "HitsoundStream.h"
+#include "Profiler.h"
 #include "Tile.h"
 
 class State;
 
+/**
+ * Options of the headless mode, which plays a level with autoplay at a fixed timestep and writes every frame to
+ * an image sequence instead of opening a window.
+ */
+struct HeadlessOptions
+{
+    std::filesystem::path levelPath;
+    std::filesystem::path outputDir;
+    sf::Vector2u size{1280, 720};
+    uint32_t framerate = 60;
+    std::string extension = ".png";
+    bool renderFrames = true; // Without rendering the level is only simulated, as fast as possible.
+    std::filesystem::path tracePath; // If set, the profiler's trace of the run is exported there at the end.
+};
+
 class Game
 {
 public:
     Game(const Game&) = delete;
     Game& operator=(const Game&) = delete;
     Game();
+    explicit Game(HeadlessOptions l_headless);
     ~Game();
     void run();
+    /**
+     * Plays the level of the headless options to the end. Failing to write a frame throws.
+     * @return false if the trace could not be written.
+     */
+    [[nodiscard]] bool runHeadless();
     void changeState(State* state);
     void pushState(State* state);
     void popState();
@@ -28,16 +51,21 @@ public:
     void render();
 
     void createWindow();
-    void calcFps();
+    sf::RenderTarget& renderTarget()
+    {
+        if (headless)
+            return renderTexture;
+        return window;
+    }
 
     sf::RenderWindow window;
+    sf::RenderTexture renderTexture;
     sf::Vector2u windowSize;
     sf::Time deltaTime;
-    float fps;
     float planetRadiusPx;
 
-    std::array<float, 60> arrFps;
-    float avgFps, minFps, maxFps;
+    Profiler profiler;
+    bool showProfiler;
 
     sf::ContextSettings settings;
     sf::View view;
@@ -45,6 +73,7 @@ public:
     sf::Font font;
 
     sf::Music music;
+    std::optional<HitsoundStream> hitsoundStream; // Only in windowed games, so headless runs never open audio.
 
     AdoCpp::Level level;
     AdoCpp::Camera camera;
@@ -62,4 +91,6 @@ public:
     sf::Clock deltaClock;
 
     Config config;
+
+    std::optional<HeadlessOptions> headless;
 };
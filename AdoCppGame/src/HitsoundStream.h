@@ -0,0 +1,212 @@
+#pragma once
+#include <AdoCpp.h>
+#include <SFML/Audio.hpp>
+#include <array>
+#include <filesystem>
+#include <mutex>
+#include "AudioProcessing.h"
+
+/**
+ * Plays the music of a level with its hitsounds mixed in live, instead of baking them into a copy of the music.
+ *
+ * The song is decoded in the audio callback and the voices are added to the same buffer, so every hitsound lands on
+ * its exact frame of the music and the playing offset of the stream is the music time. The mix goes through the
+ * LookAheadLimiter of the exported copies, so it sounds the same as they do. Onsets come from a sorted list, so
+ * edits show up as soon as setTiles is called again. Each Hitsound type uses "assets/sound/<name>.wav" when
+ * it exists and hit.wav otherwise. Without a song, the stream plays the hitsounds alone and follows sync().
+ */
+class HitsoundStream final : public sf::SoundStream
+{
+public:
+    static constexpr uint64_t chunkFrames = 512;
+    static constexpr float maxDrift = 0.03f; // in seconds, only without a song
+
+    HitsoundStream()
+    {
+        m_buffers[0 /* None */] = sf::SoundBuffer("assets/sound/hit.wav");
+        for (size_t i = 1; i < m_buffers.size(); i++)
+        {
+            const std::filesystem::path path = std::filesystem::path("assets/sound") /
+                (std::string(AdoCpp::cstrHitsound[i]) + ".wav");
+            if (!std::filesystem::exists(path) || !m_buffers[i].loadFromFile(path))
+                m_buffers[i] = m_buffers[0];
+        }
+        close();
+    }
+    ~HitsoundStream() override { stop(); }
+
+    /**
+     * Plays a song under the hitsounds from now on. Stops the stream.
+     * @return Whether the song was opened. The stream plays the hitsounds alone otherwise.
+     */
+    [[nodiscard]] bool openFromFile(const std::filesystem::path& path)
+    {
+        stop();
+        if (!m_music.openFromFile(path))
+        {
+            close();
+            return false;
+        }
+        m_hasMusic = true;
+        setFormat(m_music.getSampleRate(), m_music.getChannelCount(), m_music.getChannelMap());
+        return true;
+    }
+    /**
+     * Plays the hitsounds alone from now on. Stops the stream.
+     */
+    void close()
+    {
+        stop();
+        m_hasMusic = false;
+        setFormat(44100, 2, {sf::SoundChannel::FrontLeft, sf::SoundChannel::FrontRight});
+    }
+    [[nodiscard]] bool hasMusic() const { return m_hasMusic; }
+
+    /**
+     * Rebuilds the onsets from parsed tiles. Safe to call while playing.
+     */
+    void setTiles(const std::vector<AdoCpp::Tile>& tiles)
+    {
+        std::vector<Onset> onsets;
+        for (size_t k = 1 /* tile[0].beat = -INF */; k < tiles.size(); k++)
+        {
+            if (tiles[k].angle.deg() == 999 || tiles[k].seconds < 0)
+                continue;
+            const bool midspin = k != tiles.size() - 1 && tiles[k + 1].angle.deg() == 999;
+            const AdoCpp::Hitsound hitsound = midspin ? tiles[k].midspinHitsound : tiles[k].hitsound;
+            if (hitsound == AdoCpp::Hitsound::None)
+                continue;
+            const double volume = midspin ? tiles[k].midspinHitsoundVolume : tiles[k].hitsoundVolume;
+            onsets.push_back({tiles[k].seconds, 0, static_cast<float>(volume / 100), static_cast<uint8_t>(hitsound)});
+        }
+        std::ranges::stable_sort(onsets, {}, &Onset::seconds);
+        std::scoped_lock lock(m_mutex);
+        m_onsets = std::move(onsets);
+        placeOnsets();
+    }
+
+    /**
+     * Keeps a stream without a song at an outside clock: starts it when needed and seeks it when it has drifted.
+     * A stream with a song is the clock itself and is controlled like sf::Music instead.
+     * @param seconds The current level time in seconds.
+     */
+    void sync(const double seconds)
+    {
+        if (seconds < 0)
+        {
+            stop();
+            return;
+        }
+        if (getStatus() != Status::Playing)
+            setPlayingOffset(sf::seconds(static_cast<float>(seconds))), play();
+        else if (std::abs(getPlayingOffset().asSeconds() - seconds) > maxDrift)
+            setPlayingOffset(sf::seconds(static_cast<float>(seconds)));
+    }
+
+private:
+    struct Onset
+    {
+        double seconds;
+        uint64_t frame;
+        float gain;
+        uint8_t sound;
+    };
+
+    /**
+     * Switches the stream to a format and resamples the sounds to it. The stream must be stopped.
+     */
+    void setFormat(const unsigned sampleRate, const unsigned channelCount, const std::vector<sf::SoundChannel>& map)
+    {
+        {
+            std::scoped_lock lock(m_musicMutex, m_mutex);
+            m_sampleRate = sampleRate, m_channelCount = channelCount;
+            m_maxSoundFrames = 0;
+            for (size_t i = 1 /* None */; i < m_sounds.size(); i++)
+            {
+                m_sounds[i] = resampleHitsound(m_buffers[i], sampleRate, channelCount);
+                m_maxSoundFrames = std::max<uint64_t>(m_maxSoundFrames, m_sounds[i].size() / channelCount);
+            }
+            m_decoded.resize(chunkFrames * channelCount), m_mix.resize(chunkFrames * channelCount);
+            m_limiter = LookAheadLimiter(channelCount, sampleRate);
+            m_frame = 0;
+            placeOnsets();
+        }
+        initialize(channelCount, sampleRate, map);
+    }
+    /**
+     * Converts the onset times to frames at the current sample rate. Requires m_mutex.
+     */
+    void placeOnsets()
+    {
+        for (Onset& onset : m_onsets)
+            onset.frame = static_cast<uint64_t>(onset.seconds * m_sampleRate);
+    }
+
+    bool onGetData(Chunk& data) override
+    {
+        // The song is decoded under its own lock, so setTiles never waits for the disk.
+        std::scoped_lock musicLock(m_musicMutex);
+        uint64_t musicSamples = 0;
+        if (m_hasMusic)
+            musicSamples = m_music.read(m_decoded.data(), m_decoded.size());
+        for (size_t i = 0; i < m_mix.size(); i++)
+            m_mix[i] = i < musicSamples ? m_decoded[i] : 0.f;
+
+        const uint64_t frameEnd = m_frame + chunkFrames;
+        bool hitsRemain;
+        {
+            std::scoped_lock lock(m_mutex);
+            hitsRemain = !m_onsets.empty() && m_frame < m_onsets.back().frame + m_maxSoundFrames;
+            // The longest sound bounds how far back an overlapping onset can start.
+            const uint64_t firstOverlapping = m_frame >= m_maxSoundFrames ? m_frame - m_maxSoundFrames + 1 : 0;
+            for (auto it = std::ranges::lower_bound(m_onsets, firstOverlapping, {}, &Onset::frame);
+                 it != m_onsets.end() && it->frame < frameEnd; ++it)
+            {
+                const std::vector<float>& sound = m_sounds[it->sound];
+                const uint64_t soundEnd = it->frame + sound.size() / m_channelCount;
+                if (soundEnd <= m_frame)
+                    continue;
+                const uint64_t begin = std::max(it->frame, m_frame), end = std::min(soundEnd, frameEnd);
+                const float* src = sound.data() + (begin - it->frame) * m_channelCount;
+                float* dst = m_mix.data() + (begin - m_frame) * m_channelCount;
+                for (uint64_t i = 0; i < (end - begin) * m_channelCount; i++)
+                    dst[i] += src[i] * it->gain;
+            }
+        }
+        m_frame = frameEnd;
+
+        // Past the end of the song, the stream goes on until the last hitsound has played out, and then flushes the
+        // frames the limiter still holds back.
+        const bool end = m_hasMusic && musicSamples == 0 && !hitsRemain;
+        if (!end)
+            m_limiter.push(m_mix);
+        m_limiter.pull(m_samples, end);
+        if (m_samples.empty())
+            return false;
+        data.samples = m_samples.data(), data.sampleCount = m_samples.size();
+        return true;
+    }
+    void onSeek(const sf::Time timeOffset) override
+    {
+        std::scoped_lock lock(m_musicMutex);
+        m_frame = static_cast<uint64_t>(timeOffset.asMicroseconds()) * m_sampleRate / 1000000;
+        m_limiter = LookAheadLimiter(m_channelCount, m_sampleRate);
+        if (m_hasMusic)
+            m_music.seek(timeOffset);
+    }
+
+    std::array<sf::SoundBuffer, std::size(AdoCpp::cstrHitsound)> m_buffers; // [0] is hit.wav, the fallback.
+    std::array<std::vector<float>, std::size(AdoCpp::cstrHitsound)> m_sounds; // Resampled to the song.
+    uint64_t m_maxSoundFrames{};
+    std::mutex m_musicMutex; // Guards the song and the playback position.
+    sf::InputSoundFile m_music;
+    bool m_hasMusic{};
+    unsigned m_sampleRate{}, m_channelCount{};
+    uint64_t m_frame{};
+    std::vector<int16_t> m_decoded;
+    std::vector<float> m_mix;
+    LookAheadLimiter m_limiter{2, 44100};
+    std::vector<int16_t> m_samples;
+    std::mutex m_mutex; // Guards the onsets.
+    std::vector<Onset> m_onsets;
+};
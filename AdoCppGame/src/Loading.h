@@ -0,0 +1,187 @@
+#pragma once
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/**
+ * Thrown by LoadProgress::enter when the load has been cancelled, to unwind the job.
+ */
+struct LoadCancelled
+{
+};
+
+/**
+ * What a loading job is doing, shared between the worker thread and the render loop.
+ */
+class LoadProgress
+{
+public:
+    /**
+     * Moves on to the next stage.
+     * @param stage A short description of the stage. Must be a string literal.
+     * @param fraction How much of the whole load is done when the stage starts, from 0 to 1.
+     * @throw LoadCancelled The load has been cancelled.
+     */
+    void enter(const char* stage, const float fraction)
+    {
+        if (cancelled())
+            throw LoadCancelled{};
+        m_fraction.store(fraction, std::memory_order_relaxed);
+        m_stage.store(stage, std::memory_order_relaxed);
+    }
+    void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+    [[nodiscard]] bool cancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+    [[nodiscard]] const char* stage() const { return m_stage.load(std::memory_order_relaxed); }
+    [[nodiscard]] float fraction() const { return m_fraction.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<const char*> m_stage{"Waiting"};
+    std::atomic<float> m_fraction{};
+    std::atomic<bool> m_cancelled{};
+};
+
+/**
+ * The threads of every LoadTask, including the cancelled and abandoned ones, so that none of them is still running
+ * when the process exits.
+ */
+class LoadThreads
+{
+public:
+    /**
+     * Keeps the thread of a job. Threads whose job is done are joined on the way.
+     * @param progress The progress of the job, to cancel it on shutdown. Keeps the job's state alive.
+     * @param done Set by the job when it has finished. Must live as long as progress.
+     */
+    static void add(std::thread thread, std::shared_ptr<LoadProgress> progress, const std::atomic<bool>& done)
+    {
+        std::scoped_lock lock(instance().m_mutex);
+        std::erase_if(instance().m_threads,
+                      [](Entry& entry)
+                      {
+                          if (!entry.done->load(std::memory_order_acquire))
+                              return false;
+                          entry.thread.join();
+                          return true;
+                      });
+        instance().m_threads.push_back({std::move(thread), std::move(progress), &done});
+    }
+    /**
+     * Cancels every job and waits for all of them to finish. Called when the game shuts down.
+     */
+    static void joinAll()
+    {
+        std::scoped_lock lock(instance().m_mutex);
+        for (auto& entry : instance().m_threads)
+            entry.progress->cancel();
+        for (auto& entry : instance().m_threads)
+            entry.thread.join();
+        instance().m_threads.clear();
+    }
+
+private:
+    struct Entry
+    {
+        std::thread thread;
+        std::shared_ptr<LoadProgress> progress;
+        const std::atomic<bool>* done;
+    };
+    LoadThreads() = default;
+    ~LoadThreads() { joinAll(); }
+    static LoadThreads& instance()
+    {
+        static LoadThreads threads;
+        return threads;
+    }
+
+    std::mutex m_mutex;
+    std::vector<Entry> m_threads;
+};
+
+/**
+ * Runs a loading job on its own thread and hands its result to the render loop once it is complete.
+ *
+ * The job receives a LoadProgress to report its stages through; cancelling takes effect at the next stage.
+ * A cancelled or abandoned job finishes in the background and its result is dropped, so cancelling never blocks
+ * the render loop. The job must therefore not touch anything the render loop owns. Its thread is kept by
+ * LoadThreads, which the game joins on shutdown.
+ */
+template <typename T>
+class LoadTask
+{
+public:
+    LoadTask() = default;
+    template <typename Job>
+    explicit LoadTask(Job job) : m_state(std::make_shared<State>())
+    {
+        std::thread thread(
+            [state = m_state, job = std::move(job)]
+            {
+                try
+                {
+                    state->result.emplace(job(state->progress));
+                }
+                catch (const LoadCancelled&)
+                {
+                }
+                catch (...)
+                {
+                    state->error = std::current_exception();
+                }
+                state->done.store(true, std::memory_order_release);
+            });
+        LoadThreads::add(std::move(thread), std::shared_ptr<LoadProgress>(m_state, &m_state->progress), m_state->done);
+    }
+    LoadTask(const LoadTask&) = delete;
+    LoadTask& operator=(const LoadTask&) = delete;
+    LoadTask(LoadTask&&) noexcept = default;
+    LoadTask& operator=(LoadTask&& other) noexcept
+    {
+        cancel();
+        m_state = std::move(other.m_state);
+        return *this;
+    }
+    ~LoadTask() { cancel(); }
+
+    /**
+     * Whether a job is running or has a result that has not been taken yet.
+     */
+    [[nodiscard]] bool valid() const { return m_state != nullptr; }
+    /**
+     * Whether the job has finished, successfully or not. take() does not block after this returns true.
+     */
+    [[nodiscard]] bool ready() const { return m_state && m_state->done.load(std::memory_order_acquire); }
+    [[nodiscard]] const LoadProgress& progress() const { return m_state->progress; }
+    /**
+     * Abandons the job. The task is invalid afterwards.
+     */
+    void cancel()
+    {
+        if (m_state)
+            m_state->progress.cancel(), m_state.reset();
+    }
+    /**
+     * Takes the result of a ready job. The task is invalid afterwards.
+     * @throw ... Whatever the job threw.
+     */
+    T take()
+    {
+        const std::shared_ptr<State> state = std::move(m_state);
+        if (state->error)
+            std::rethrow_exception(state->error);
+        return std::move(*state->result);
+    }
+
+private:
+    struct State
+    {
+        LoadProgress progress;
+        std::optional<T> result;
+        std::exception_ptr error;
+        std::atomic<bool> done{};
+    };
+    std::shared_ptr<State> m_state;
+};
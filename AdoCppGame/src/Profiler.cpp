@@ -0,0 +1,236 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <imgui.h>
+#include <implot.h>
+
+Profiler::Profiler() : m_epoch(std::chrono::steady_clock::now()), m_slots(std::make_unique<Slot[]>(capacity)) {}
+
+uint16_t Profiler::threadId()
+{
+    static std::atomic<uint16_t> next;
+    thread_local const uint16_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+uint8_t& Profiler::depth()
+{
+    thread_local uint8_t depth = 0;
+    return depth;
+}
+
+int64_t Profiler::now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+void Profiler::record(const Record& record)
+{
+    const uint64_t index = m_head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = m_slots[index % capacity];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.header.store(static_cast<uint64_t>(record.zone) | static_cast<uint64_t>(record.depth) << 8 |
+                          static_cast<uint64_t>(record.thread) << 16,
+                      std::memory_order_relaxed);
+    slot.frame.store(record.frame, std::memory_order_relaxed);
+    slot.begin.store(record.begin, std::memory_order_relaxed);
+    slot.end.store(record.end, std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+bool Profiler::read(const uint64_t index, Record& record) const
+{
+    const Slot& slot = m_slots[index % capacity];
+    const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * index + 2)
+        return false; // Still being written, or already overwritten by a newer record.
+    const uint64_t header = slot.header.load(std::memory_order_relaxed);
+    record.zone = static_cast<Zone>(header & 0xff);
+    record.depth = static_cast<uint8_t>(header >> 8 & 0xff);
+    record.thread = static_cast<uint16_t>(header >> 16 & 0xffff);
+    record.frame = slot.frame.load(std::memory_order_relaxed);
+    record.begin = slot.begin.load(std::memory_order_relaxed);
+    record.end = slot.end.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+std::vector<Profiler::Record> Profiler::snapshot() const
+{
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    std::vector<Record> records;
+    records.reserve(std::min<uint64_t>(head, capacity));
+    Record record{};
+    for (uint64_t index = head > capacity ? head - capacity : 0; index < head; index++)
+        if (read(index, record))
+            records.push_back(record);
+    return records;
+}
+
+void Profiler::beginFrame()
+{
+    m_frameBegin = now();
+    m_frameFirstRecord = m_head.load(std::memory_order_relaxed);
+    depth()++; // Every zone of the frame nests in Frame.
+}
+
+void Profiler::endFrame()
+{
+    depth()--;
+    const uint64_t frameNumber = frame();
+    const uint16_t thread = threadId();
+    record({Zone::Frame, depth(), thread, frameNumber, m_frameBegin, now()});
+
+    // Collect the zones of this frame on this thread.
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    m_frameRecords.clear();
+    Record record{};
+    for (uint64_t index = std::max(m_frameFirstRecord, head > capacity ? head - capacity : 0); index < head; index++)
+        if (read(index, record) && record.frame == frameNumber && record.thread == thread)
+            m_frameRecords.push_back(record);
+    std::ranges::sort(m_frameRecords, [](const Record& a, const Record& b)
+                      { return a.begin != b.begin ? a.begin < b.begin : a.depth < b.depth; });
+
+    // A zone's own time is its duration minus that of the zones directly inside it.
+    FrameSample& sample = m_history[m_historyCount++ % historySize];
+    sample = {frameNumber, 0, {}};
+    std::vector<const Record*> open;
+    for (const Record& zone : m_frameRecords)
+    {
+        while (!open.empty() && open.back()->end <= zone.begin)
+            open.pop_back();
+        const double ms = static_cast<double>(zone.end - zone.begin) / 1e6;
+        if (!open.empty())
+            sample.exclusiveMs[static_cast<size_t>(open.back()->zone)] -= ms;
+        sample.exclusiveMs[static_cast<size_t>(zone.zone)] += ms;
+        if (zone.zone == Zone::Frame)
+            sample.totalMs = ms;
+        open.push_back(&zone);
+    }
+    m_frame.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<Profiler::FrameSample> Profiler::history() const
+{
+    const size_t count = std::min(m_historyCount, historySize), first = m_historyCount - count;
+    std::vector<FrameSample> frames;
+    frames.reserve(count);
+    for (size_t i = first; i < m_historyCount; i++)
+        frames.push_back(m_history[i % historySize]);
+    return frames;
+}
+
+Profiler::FpsStats Profiler::fpsStats() const
+{
+    const std::vector<FrameSample> frames = history();
+    if (frames.empty())
+        return {};
+    double sum = 0, shortest = std::numeric_limits<double>::infinity(), longest = 0;
+    for (const FrameSample& frame : frames)
+        sum += frame.totalMs, shortest = std::min(shortest, frame.totalMs), longest = std::max(longest, frame.totalMs);
+    if (sum <= 0 || shortest <= 0)
+        return {};
+    return {static_cast<float>(1000 * static_cast<double>(frames.size()) / sum), static_cast<float>(1000 / longest),
+            static_cast<float>(1000 / shortest)};
+}
+
+void Profiler::exportChromeTrace(std::ostream& os) const
+{
+    const std::vector<Record> records = snapshot();
+    os << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::vector<uint16_t> threads;
+    for (const Record& record : records)
+    {
+        // Complete events, in microseconds.
+        os << (first ? "\n" : ",\n") << R"({"name":")" << zoneNames[static_cast<size_t>(record.zone)]
+           << R"(","cat":"game","ph":"X","pid":1,"tid":)" << record.thread
+           << ",\"ts\":" << static_cast<double>(record.begin) / 1e3
+           << ",\"dur\":" << static_cast<double>(record.end - record.begin) / 1e3
+           << ",\"args\":{\"frame\":" << record.frame << "}}";
+        first = false;
+        if (std::ranges::find(threads, record.thread) == threads.end())
+            threads.push_back(record.thread);
+    }
+    for (const uint16_t thread : threads)
+    {
+        os << (first ? "\n" : ",\n") << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << thread
+           << R"(,"args":{"name":"Thread )" << thread << "\"}}";
+        first = false;
+    }
+    os << "\n]}\n";
+}
+
+bool Profiler::exportChromeTrace(const std::filesystem::path& path) const
+{
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs)
+        return false;
+    exportChromeTrace(ofs);
+    return static_cast<bool>(ofs);
+}
+
+void Profiler::drawOverlay(bool* open)
+{
+    ImGui::SetNextWindowSize(ImVec2(720, 480), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler", open))
+    {
+        ImGui::End();
+        return;
+    }
+    const std::vector<FrameSample> frames = history();
+    const auto [avg, min, max] = fpsStats();
+    ImGui::Text("FPS: %.0f avg, %.0f min, %.0f max", avg, min, max);
+    ImGui::SameLine();
+    if (ImGui::Button("Export trace"))
+    {
+        const std::filesystem::path path = std::filesystem::absolute("AdoCppTrace.json");
+        m_exportStatus = exportChromeTrace(path) ? "Saved to " + path.string() : "Failed to write " + path.string();
+    }
+    if (!m_exportStatus.empty())
+        ImGui::TextUnformatted(m_exportStatus.c_str());
+
+    // The own time of every zone, stacked per frame. What no zone covers is shown as Other.
+    std::array<const char*, zoneCount> labels = zoneNames;
+    labels[static_cast<size_t>(Zone::Frame)] = "Other";
+    const auto frameCount = static_cast<int>(frames.size());
+    std::vector<double> values(zoneCount * frames.size());
+    for (size_t zone = 0; zone < zoneCount; zone++)
+        for (size_t i = 0; i < frames.size(); i++)
+            values[zone * frames.size() + i] = std::max(0.0, frames[i].exclusiveMs[zone]);
+    if (ImPlot::BeginPlot("##Frames", ImVec2(-1, ImGui::GetContentRegionAvail().y * 0.6f)))
+    {
+        ImPlot::SetupAxes("Frame", "ms", ImPlotAxisFlags_NoTickLabels | ImPlotAxisFlags_AutoFit,
+                          ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupLegend(ImPlotLocation_NorthEast, ImPlotLegendFlags_Outside);
+        if (frameCount > 0)
+            ImPlot::PlotBarGroups(labels.data(), values.data(), static_cast<int>(zoneCount), frameCount, 1, 0,
+                                  ImPlotBarGroupsFlags_Stacked);
+        ImPlot::EndPlot();
+    }
+
+    if (ImGui::BeginTable("##Zones", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+    {
+        ImGui::TableSetupColumn("Zone");
+        ImGui::TableSetupColumn("Avg [ms]");
+        ImGui::TableSetupColumn("Max [ms]");
+        ImGui::TableHeadersRow();
+        const auto row = [&](const char* name, const auto& ms)
+        {
+            double sum = 0, longest = 0;
+            for (const FrameSample& frame : frames)
+                sum += ms(frame), longest = std::max(longest, ms(frame));
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(), ImGui::TextUnformatted(name);
+            ImGui::TableNextColumn(), ImGui::Text("%.3f", frames.empty() ? 0 : sum / frameCount);
+            ImGui::TableNextColumn(), ImGui::Text("%.3f", longest);
+        };
+        row("Frame (total)", [](const FrameSample& frame) { return frame.totalMs; });
+        for (size_t zone = 0; zone < zoneCount; zone++)
+            row(labels[zone], [zone](const FrameSample& frame) { return frame.exclusiveMs[zone]; });
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * A frame profiler for the game loop.
+ *
+ * ProfileZone records the begin and end of a scope into a fixed-size ring buffer. Any thread can write to it
+ * without locking: writers claim slots with an atomic counter and publish them with a sequence number, and readers
+ * skip the slots that are overwritten while they read them. At the end of every frame the zones of the frame are
+ * summed up into a short history for the overlay. The whole buffer can be exported as a Chrome trace
+ * (chrome://tracing or ui.perfetto.dev).
+ */
+class Profiler
+{
+public:
+    enum class Zone : uint8_t
+    {
+        Frame,
+        HandleEvent,
+        ImGuiUpdate,
+        StateUpdate,
+        LevelUpdate,
+        Judgement,
+        TileSystemUpdate,
+        StateRender,
+        TileSystemDraw,
+        ImGuiRender,
+        Display,
+        Count
+    };
+    static constexpr size_t zoneCount = static_cast<size_t>(Zone::Count);
+    static constexpr std::array<const char*, zoneCount> zoneNames = {
+        "Frame",         "handleEvent",      "ImGui::SFML::Update", "State::update",
+        "Level::update", "Judgement",        "TileSystem::update",  "State::render",
+        "TileSystem::draw", "ImGui::SFML::Render", "window.display"};
+    static constexpr size_t capacity = 1 << 16; // records
+    static constexpr size_t historySize = 240;  // frames
+
+    struct Record
+    {
+        Zone zone;
+        uint8_t depth;
+        uint16_t thread;
+        uint64_t frame;
+        int64_t begin, end; // in nanoseconds since the profiler was created
+    };
+    /**
+     * A frame of the history. The time of a zone excludes the zones nested in it; the time of Frame is what no
+     * zone covers.
+     */
+    struct FrameSample
+    {
+        uint64_t frame;
+        double totalMs;
+        std::array<double, zoneCount> exclusiveMs;
+    };
+    struct FpsStats
+    {
+        float avg, min, max;
+    };
+
+    Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    /**
+     * Starts a frame. The zones of the calling thread until endFrame() belong to it.
+     */
+    void beginFrame();
+    /**
+     * Records the Frame zone and adds the frame to the history.
+     */
+    void endFrame();
+
+    void record(const Record& record);
+    [[nodiscard]] int64_t now() const;
+    [[nodiscard]] uint64_t frame() const { return m_frame.load(std::memory_order_relaxed); }
+    /**
+     * The records still in the ring buffer, oldest first.
+     */
+    [[nodiscard]] std::vector<Record> snapshot() const;
+    /**
+     * The frames of the history, oldest first.
+     */
+    [[nodiscard]] std::vector<FrameSample> history() const;
+    [[nodiscard]] FpsStats fpsStats() const;
+
+    void exportChromeTrace(std::ostream& os) const;
+    bool exportChromeTrace(const std::filesystem::path& path) const;
+
+    /**
+     * Draws the breakdown of the last frames with ImPlot. Must be called between ImGui::SFML::Update and
+     * ImGui::SFML::Render.
+     */
+    void drawOverlay(bool* open);
+
+    /**
+     * The number of the calling thread in the records.
+     */
+    static uint16_t threadId();
+    /**
+     * How many zones of the calling thread are open.
+     */
+    static uint8_t& depth();
+
+private:
+    struct Slot
+    {
+        // 2 * index + 1 while the record of that index is written, 2 * index + 2 once it is complete.
+        std::atomic<uint64_t> sequence{};
+        std::atomic<uint64_t> header{}; // zone | depth << 8 | thread << 16
+        std::atomic<uint64_t> frame{};
+        std::atomic<int64_t> begin{}, end{};
+    };
+    bool read(uint64_t index, Record& record) const;
+
+    std::chrono::steady_clock::time_point m_epoch;
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<uint64_t> m_head{};
+    std::atomic<uint64_t> m_frame{};
+
+    // Only touched by the thread that runs the frames.
+    int64_t m_frameBegin{};
+    uint64_t m_frameFirstRecord{};
+    std::array<FrameSample, historySize> m_history{};
+    size_t m_historyCount{};
+    std::vector<Record> m_frameRecords;
+    std::string m_exportStatus;
+};
+
+/**
+ * Records the lifetime of a scope as a zone of the current frame.
+ */
+class ProfileZone
+{
+public:
+    ProfileZone(Profiler& profiler, const Profiler::Zone zone) :
+        m_profiler(profiler), m_zone(zone), m_depth(Profiler::depth()++), m_begin(profiler.now())
+    {
+    }
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+    ~ProfileZone()
+    {
+        Profiler::depth()--;
+        m_profiler.record({m_zone, m_depth, Profiler::threadId(), m_profiler.frame(), m_begin, m_profiler.now()});
+    }
+
+private:
+    Profiler& m_profiler;
+    Profiler::Zone m_zone;
+    uint8_t m_depth;
+    int64_t m_begin;
+};
@@ -0,0 +1,171 @@
+#include "Spectrogram.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include "Fft.h"
+
+/**
+ * Maps 0 (silence) .. 1 (full scale) to a dark-blue-to-yellow gradient.
+ */
+static std::array<uint8_t, 4> colorize(const float t)
+{
+    static constexpr std::array<std::array<float, 3>, 5> stops = {
+        {{0, 0, 0}, {40, 10, 110}, {180, 30, 120}, {250, 130, 40}, {255, 250, 160}}};
+    const float x = std::clamp(t, 0.f, 1.f) * (stops.size() - 1);
+    const size_t i = std::min(static_cast<size_t>(x), stops.size() - 2);
+    const float f = x - static_cast<float>(i);
+    std::array<uint8_t, 4> color{0, 0, 0, 255};
+    for (size_t c = 0; c < 3; c++)
+        color[c] = static_cast<uint8_t>(stops[i][c] + (stops[i + 1][c] - stops[i][c]) * f);
+    return color;
+}
+
+Spectrogram::Spectrogram(const int16_t* samples, const uint64_t frameCount, const unsigned channelCount,
+                         const unsigned sampleRate) :
+    m_samples(samples), m_frameCount(frameCount), m_channelCount(channelCount), m_sampleRate(sampleRate),
+    m_worker(&Spectrogram::work, this)
+{
+}
+
+Spectrogram::~Spectrogram()
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_one();
+    m_worker.join();
+}
+
+std::vector<Spectrogram::Tile> Spectrogram::visibleTiles(double begin, double end, const unsigned fftSize,
+                                                         const unsigned hop)
+{
+    const double duration = static_cast<double>(m_frameCount) / m_sampleRate;
+    const double blockSeconds = static_cast<double>(tileColumns) * hop / m_sampleRate;
+    begin = std::max(begin, 0.0), end = std::min(end, duration);
+    std::vector<Tile> tiles;
+    if (begin >= end)
+        return tiles;
+    const auto firstBlock = static_cast<uint64_t>(begin / blockSeconds),
+               lastBlock = static_cast<uint64_t>(end / blockSeconds);
+
+    std::map<Key, std::vector<uint8_t>> finished;
+    bool pending;
+    {
+        std::scoped_lock lock(m_mutex);
+        // Only what is visible now is worth computing. The middle of the view goes first.
+        m_pending.clear();
+        const uint64_t middle = (firstBlock + lastBlock) / 2;
+        std::vector<uint64_t> blocks;
+        for (uint64_t block = firstBlock; block <= lastBlock; block++)
+            blocks.push_back(block);
+        std::ranges::sort(blocks, std::greater{},
+                          [middle](const uint64_t block) { return block > middle ? block - middle : middle - block; });
+        for (const uint64_t block : blocks)
+            if (const Key key{block, fftSize, hop}; !m_cache.contains(key) && !m_finished.contains(key) &&
+                !(m_computing && m_computingKey == key))
+                m_pending.push_back(key);
+        // Upload a few per frame so that a burst of finished tiles does not stall a frame.
+        for (auto it = m_finished.begin(); it != m_finished.end() && finished.size() < maxUploadsPerFrame;)
+            finished.insert(m_finished.extract(it++));
+        pending = !m_pending.empty();
+    }
+    if (pending)
+        m_condition.notify_one();
+
+    for (auto& [key, pixels] : finished)
+    {
+        CachedTile& cached = m_cache[key];
+        if (!cached.texture.resize({tileColumns, tileRows}))
+        {
+            m_cache.erase(key);
+            continue;
+        }
+        cached.texture.update(pixels.data());
+        cached.lruPosition = m_lru.insert(m_lru.begin(), key);
+    }
+    for (uint64_t block = firstBlock; block <= lastBlock; block++)
+    {
+        const auto it = m_cache.find({block, fftSize, hop});
+        if (it == m_cache.end())
+            continue;
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+        tiles.push_back({&it->second.texture, static_cast<double>(block) * blockSeconds,
+                         static_cast<double>(block + 1) * blockSeconds});
+    }
+    // Visible tiles are at the front of the LRU list, so eviction never touches what is returned.
+    while (m_cache.size() > std::max(maxCachedTiles, tiles.size()))
+    {
+        m_cache.erase(m_lru.back());
+        m_lru.pop_back();
+    }
+    return tiles;
+}
+
+void Spectrogram::work()
+{
+    std::unique_lock lock(m_mutex);
+    while (true)
+    {
+        m_condition.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+        if (m_stop)
+            return;
+        const Key key = m_pending.back();
+        m_pending.pop_back();
+        m_computing = true, m_computingKey = key;
+        lock.unlock();
+        std::vector<uint8_t> pixels = computeTile(key);
+        lock.lock();
+        m_computing = false;
+        m_finished.emplace(key, std::move(pixels));
+    }
+}
+
+std::vector<uint8_t> Spectrogram::computeTile(const Key& key) const
+{
+    const unsigned n = key.fftSize, bins = n / 2 + 1;
+    const Fft fft(n);
+    const std::vector<float> window = hannWindow(n);
+    // The bins of each row, log-spaced from minFrequency up to Nyquist.
+    std::array<std::pair<unsigned, unsigned>, tileRows> rowBins;
+    const double nyquist = m_sampleRate / 2.0, ratio = nyquist / minFrequency;
+    for (unsigned row = 0; row < tileRows; row++)
+    {
+        const double high = minFrequency * std::pow(ratio, 1 - static_cast<double>(row) / tileRows),
+                     low = minFrequency * std::pow(ratio, 1 - static_cast<double>(row + 1) / tileRows);
+        const auto lo = std::min(bins - 1, static_cast<unsigned>(std::floor(low * n / m_sampleRate)));
+        const auto hi = std::min(bins, static_cast<unsigned>(std::ceil(high * n / m_sampleRate)));
+        rowBins[row] = {lo, std::max(hi, lo + 1)};
+    }
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(tileColumns) * tileRows * 4);
+    std::vector<std::complex<float>> buffer(n);
+    std::vector<float> magnitudes(bins);
+    // Full scale for a sine through a Hann window is about n / 4.
+    const float scale = 1.f / (32768.f * static_cast<float>(m_channelCount)), reference = static_cast<float>(n) / 4;
+    for (unsigned column = 0; column < tileColumns; column++)
+    {
+        const auto start = static_cast<int64_t>((key.block * tileColumns + column) * key.hop) - n / 2;
+        for (unsigned i = 0; i < n; i++)
+        {
+            const int64_t frame = start + i;
+            float sum = 0;
+            if (frame >= 0 && static_cast<uint64_t>(frame) < m_frameCount)
+                for (unsigned c = 0; c < m_channelCount; c++)
+                    sum += m_samples[frame * m_channelCount + c];
+            buffer[i] = sum * scale * window[i];
+        }
+        fft.transform(buffer);
+        for (unsigned k = 0; k < bins; k++)
+            magnitudes[k] = std::abs(buffer[k]);
+        for (unsigned row = 0; row < tileRows; row++)
+        {
+            const auto [lo, hi] = rowBins[row];
+            const float magnitude = *std::max_element(magnitudes.begin() + lo, magnitudes.begin() + hi);
+            const float decibels = 20 * std::log10(std::max(magnitude / reference, 1e-6f)); // -120 .. 0
+            const auto color = colorize((decibels + 90) / 90);
+            std::ranges::copy(color, pixels.begin() + (static_cast<size_t>(row) * tileColumns + column) * 4);
+        }
+    }
+    return pixels;
+}
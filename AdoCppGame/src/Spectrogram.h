@@ -0,0 +1,83 @@
+#pragma once
+
+#include <SFML/Graphics/Texture.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A spectrogram of an int16 audio buffer, computed lazily in tiles on a worker thread.
+ *
+ * A tile holds tileColumns STFT columns with log-spaced frequency rows. Tiles are requested for the visible time
+ * range only and kept as textures in an LRU cache keyed by (time block, FFT size, hop). Finished tiles are
+ * uploaded a few per frame, so scrolling never waits for a transform.
+ */
+class Spectrogram
+{
+public:
+    static constexpr unsigned tileColumns = 256, tileRows = 256;
+    static constexpr size_t maxCachedTiles = 64;
+    static constexpr unsigned maxUploadsPerFrame = 2;
+    static constexpr float minFrequency = 30;
+
+    struct Key
+    {
+        uint64_t block;
+        unsigned fftSize, hop;
+
+        auto operator<=>(const Key&) const = default;
+    };
+    struct Tile
+    {
+        const sf::Texture* texture;
+        double begin, end; // in seconds
+    };
+
+    /**
+     * The samples must stay alive as long as the spectrogram.
+     */
+    Spectrogram(const int16_t* samples, uint64_t frameCount, unsigned channelCount, unsigned sampleRate);
+    Spectrogram(const Spectrogram&) = delete;
+    Spectrogram& operator=(const Spectrogram&) = delete;
+    ~Spectrogram();
+
+    /**
+     * Requests the tiles covering [begin, end) seconds, replacing the previous request, and uploads finished ones.
+     * Must be called from the thread that owns the OpenGL context.
+     * @param fftSize A power of two.
+     * @return The tiles of the range that are ready to draw.
+     */
+    std::vector<Tile> visibleTiles(double begin, double end, unsigned fftSize, unsigned hop);
+
+private:
+    void work();
+    /**
+     * The RGBA pixels of a tile, highest frequency first.
+     */
+    [[nodiscard]] std::vector<uint8_t> computeTile(const Key& key) const;
+
+    const int16_t* m_samples;
+    uint64_t m_frameCount;
+    unsigned m_channelCount, m_sampleRate;
+
+    struct CachedTile
+    {
+        sf::Texture texture;
+        std::list<Key>::iterator lruPosition;
+    };
+    std::map<Key, CachedTile> m_cache;
+    std::list<Key> m_lru; // The most recently used first.
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<Key> m_pending; // Computed from the back.
+    std::map<Key, std::vector<uint8_t>> m_finished;
+    bool m_computing{};
+    Key m_computingKey{};
+    bool m_stop{};
+    std::thread m_worker;
+};
@@ -195,7 +195,10 @@ void StateCharting::update()
     const auto w = static_cast<float>(game->windowSize.x), h = static_cast<float>(game->windowSize.y);
     game->view.setSize({w / (w + h) * 16 * game->zoom.x, -h / (w + h) * 16 * game->zoom.y});
     game->tileSystem.setActiveTileIndex(game->activeTileIndex);
-    game->tileSystem.update();
+    {
+        const ProfileZone zone(game->profiler, Profiler::Zone::TileSystemUpdate);
+        game->tileSystem.update();
+    }
 
     if (!sf::Mouse::isButtonPressed(sf::Mouse::Button::Left))
         dragging = false;
@@ -205,7 +208,10 @@ void StateCharting::render()
 {
     // render the world
     game->window.setView(game->view);
-    game->window.draw(game->tileSystem);
+    {
+        const ProfileZone zone(game->profiler, Profiler::Zone::TileSystemDraw);
+        game->window.draw(game->tileSystem);
+    }
 
     // render the GUI
     sf::View defaultView = game->window.getDefaultView();
@@ -273,8 +279,6 @@ void StateCharting::renderFilenameBar()
                     {
                         if (progress == -1)
                             ImGui::Text("Loading...");
-                        else if (progress == 2)
-                            ImGui::Text("Saving...");
                         else
                             ImGui::Text("Adding hitsound...");
                         ImGui::ProgressBar(std::max(0.f, std::min(1.f, progress)), ImVec2(-1, 0));
@@ -310,21 +314,56 @@ void StateCharting::renderFilenameBar()
         {
             if (ImGuiFileDialog::Instance()->IsOk())
             {
-                game->levelPath = ImGuiFileDialog::Instance()->GetFilePathName();
+                levelLoadPath = ImGuiFileDialog::Instance()->GetFilePathName();
+                levelLoad = LoadTask<AdoCpp::Level>(
+                    [path = levelLoadPath, disableAnimateTrack = game->level.disableAnimateTrack()](
+                        LoadProgress& progress)
+                    {
+                        progress.enter("Reading the level...", 0);
+                        AdoCpp::Level level(path);
+                        level.disableAnimateTrack(disableAnimateTrack);
+                        progress.enter("Parsing the level...", 0.5f);
+                        level.parse();
+                        return level;
+                    });
+                ImGui::OpenPopup("Loading level...");
+            }
+            ImGuiFileDialog::Instance()->Close();
+        }
+        bool loadFailed = false;
+        ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+        if (ImGui::BeginPopupModal("Loading level...", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+        {
+            if (!levelLoad.valid())
+                ImGui::CloseCurrentPopup();
+            else if (!levelLoad.ready())
+            {
+                ImGui::Text("%s", levelLoad.progress().stage());
+                ImGui::ProgressBar(levelLoad.progress().fraction(), ImVec2(ImGui::GetFontSize() * 15, 0));
+                if (ImGui::Button("Cancel"))
+                    levelLoad.cancel(), ImGui::CloseCurrentPopup();
+            }
+            else
+            {
+                // The old level stays on screen until the new one has been parsed, then both are swapped at once.
                 try
                 {
-                    game->level.fromFile(game->levelPath);
+                    game->level = levelLoad.take();
+                    game->levelPath = levelLoadPath;
                 }
                 catch (const AdoCpp::LevelJsonException&)
                 {
                     game->levelPath.clear();
                     game->level.defaultLevel();
-                    ImGui::OpenPopup("Error!##AdoCpp::LevelJsonHasParseErrorException");
+                    loadFailed = true;
                 }
                 newLevel();
+                ImGui::CloseCurrentPopup();
             }
-            ImGuiFileDialog::Instance()->Close();
+            ImGui::EndPopup();
         }
+        if (loadFailed)
+            ImGui::OpenPopup("Error!##AdoCpp::LevelJsonHasParseErrorException");
         if (ImGuiFileDialog::Instance()->Display("SaveFileDlgKey"))
         {
             if (ImGuiFileDialog::Instance()->IsOk())
@@ -479,6 +518,7 @@ void StateCharting::renderControlPad() const
             ImGui::TreePop();
         }
         ImGui::Checkbox("Timer Sync With Music", &game->config.syncWithMusic);
+        ImGui::Checkbox("Live Hitsound", &game->config.liveHitsound);
         if (ImGui::TreeNode("Performance"))
         {
             if (static bool disableAnimationTrack = game->level.disableAnimateTrack();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Loading.h"
 #include "State.h"
 
 class StateCharting final : public State
@@ -41,4 +42,6 @@ private:
 	static StateCharting m_stateCharting;
 	bool addedHitsound{};
     bool dragging{};
+    LoadTask<AdoCpp::Level> levelLoad;
+    std::filesystem::path levelLoadPath;
 };
\ No newline at end of file
@@ -4,8 +4,10 @@
 #include <implot.h>
 #include <iostream>
 #include <map>
+#include <ranges>
 #include <misc/cpp/imgui_stdlib.h>
 
+#include <algorithm>
 #include <cmath>
 #include "ImGuiFileDialog.h"
 
@@ -101,6 +103,22 @@ static bool ImGuiInputColor(const char* text, AdoCpp::Color* colorPtr)
     return val;
 }
 
+/**
+ * Collects the sorted times inside the current plot's X limits into out, at most one per pixel column.
+ */
+template <std::ranges::random_access_range Times>
+static void cullToPlot(Times&& times, std::vector<double>& out)
+{
+    const ImPlotRange timeRange = ImPlot::GetPlotLimits().X;
+    const double secondsPerPx = timeRange.Size() / std::max(1.f, ImPlot::GetPlotSize().x);
+    const auto first = std::ranges::lower_bound(times, timeRange.Min);
+    const auto last = std::ranges::upper_bound(first, std::ranges::end(times), timeRange.Max);
+    out.clear();
+    for (auto it = first; it != last; ++it)
+        if (out.empty() || *it - out.back() >= secondsPerPx)
+            out.push_back(*it);
+}
+
 void LiveCharting::init(Game* _game)
 {
     game = _game;
@@ -114,26 +132,26 @@ void LiveCharting::init(Game* _game)
     planet2.setRadius(0.25);
     planet1.setOrigin({planet1.getRadius(), planet1.getRadius()});
     planet2.setOrigin({planet2.getRadius(), planet2.getRadius()});
+    music = std::nullopt, spectrogram = nullptr, waveform = std::nullopt, beatAnalysis = std::nullopt;
+    soundBuffer = nullptr;
+    if (game->hitsoundStream)
+        game->hitsoundStream->close();
+    musicLoad.cancel();
     if (!game->origMusicPath.empty())
     {
-        try
-        {
-            soundBuffer = sf::SoundBuffer(game->origMusicPath);
-            music = sf::Sound(*soundBuffer);
-            const int16_t* origSamples = soundBuffer->getSamples();
-            const size_t sampleCount = soundBuffer->getSampleCount();
-            samples = std::vector<double>(sampleCount);
-            int16_t maxSample = 1;
-            for (size_t i = 0; i < sampleCount; i++)
-                maxSample = std::max(maxSample, static_cast<int16_t>(std::abs(origSamples[i])));
-            for (size_t i = 0; i < sampleCount; i++)
-                (*samples)[i] = static_cast<double>(origSamples[i]) / maxSample;
-        }
-        catch (std::exception& ex)
-        {
-            std::cerr << ex.what() << std::endl;
-            soundBuffer = std::nullopt;
-        }
+        musicLoad = LoadTask<LoadedMusic>(
+            [path = game->origMusicPath](LoadProgress& progress)
+            {
+                progress.enter("Decoding the music...", 0);
+                auto buffer = std::make_unique<sf::SoundBuffer>(path);
+                const uint64_t frameCount = buffer->getSampleCount() / buffer->getChannelCount();
+                progress.enter("Summarising the waveform...", 0.6f);
+                WaveformPyramid pyramid(buffer->getSamples(), frameCount, buffer->getChannelCount());
+                progress.enter("Detecting beats...", 0.7f);
+                BeatAnalysis beats =
+                    analyseBeats(buffer->getSamples(), frameCount, buffer->getChannelCount(), buffer->getSampleRate());
+                return LoadedMusic{std::move(buffer), std::move(pyramid), std::move(beats)};
+            });
     }
 }
 void LiveCharting::cleanup()
@@ -144,6 +162,8 @@ void LiveCharting::cleanup()
     game->tileSystem.update();
     if (music)
         music->stop();
+    if (game->hitsoundStream)
+        game->hitsoundStream->stop();
 }
 void LiveCharting::pause() {}
 void LiveCharting::resume() {}
@@ -301,7 +321,8 @@ void LiveCharting::update()
 
     if (game->level.isParsed())
     {
-        const auto [pos1, pos2] = game->level.getPlanetsPos(game->level.getFloorBySeconds(seconds), seconds);
+        nowTileIndex = game->level.getFloorBySeconds(seconds, nowTileIndex);
+        const auto [pos1, pos2] = game->level.getPlanetsPos(nowTileIndex, seconds);
         planet1.setPosition({static_cast<float>(pos1.x), static_cast<float>(pos1.y)});
         planet2.setPosition({static_cast<float>(pos2.x), static_cast<float>(pos2.y)});
     }
@@ -313,7 +334,10 @@ void LiveCharting::update()
         game->tileSystem.setTilePlaceMode(2);
     else
         game->tileSystem.setTilePlaceMode(3);
-    game->tileSystem.update();
+    {
+        const ProfileZone zone(game->profiler, Profiler::Zone::TileSystemUpdate);
+        game->tileSystem.update();
+    }
 
     if (!sf::Mouse::isButtonPressed(sf::Mouse::Button::Left))
         dragging = false;
@@ -322,7 +346,10 @@ void LiveCharting::render()
 {
     // render the world
     game->window.setView(game->view);
-    game->window.draw(game->tileSystem);
+    {
+        const ProfileZone zone(game->profiler, Profiler::Zone::TileSystemDraw);
+        game->window.draw(game->tileSystem);
+    }
     game->window.draw(planet1);
     game->window.draw(planet2);
 
@@ -345,13 +372,35 @@ void LiveCharting::renderAudioWindow()
     ImGui::SetNextWindowSize({static_cast<float>(game->windowSize.x), -1});
     if (ImGui::Begin("AudioWindow", nullptr, flags))
     {
+        if (musicLoad.ready())
+        {
+            try
+            {
+                auto [buffer, pyramid, beats] = musicLoad.take();
+                soundBuffer = std::move(buffer), waveform = std::move(pyramid), beatAnalysis = std::move(beats);
+                music = sf::Sound(*soundBuffer);
+                if (game->hitsoundStream && !game->hitsoundStream->openFromFile(game->origMusicPath))
+                    std::cerr << "Error: Failed to open the music for live hitsounds.\n";
+                spectrogram = std::make_unique<Spectrogram>(
+                    soundBuffer->getSamples(), soundBuffer->getSampleCount() / soundBuffer->getChannelCount(),
+                    soundBuffer->getChannelCount(), soundBuffer->getSampleRate());
+                render_needToUpdateOscillogram = true;
+            }
+            catch (std::exception& ex)
+            {
+                std::cerr << ex.what() << std::endl;
+            }
+        }
+        else if (musicLoad.valid())
+            ImGui::ProgressBar(musicLoad.progress().fraction(), ImVec2(-1, 0), musicLoad.progress().stage());
+        ImPlotRange timeRange;
         if (ImPlot::BeginPlot("Audio"))
         {
             // Thanks to https://github.com/epezent/implot/issues/323
             ImPlot::SetupAxes("Time [s]", "Amplitude");
             ImPlot::SetupAxisLimits(ImAxis_Y1, -1, 1, ImPlotCond_Always);
 
-            if (samples)
+            if (waveform)
             {
                 const double audioLengthInSeconds = static_cast<double>(soundBuffer->getSampleCount()) /
                     soundBuffer->getChannelCount() / soundBuffer->getSampleRate();
@@ -372,23 +421,16 @@ void LiveCharting::renderAudioWindow()
                     // clang-format off
                     const double frames      = floor((t2 - t1) * soundBuffer->getSampleRate());
                     const double framesPerPx = frames / widthPx;
-                    const int    binLength   = std::max(1.0, floor(framesPerPx + 0.5));
-                    const int    framesTotal = soundBuffer->getSampleCount() / soundBuffer->getChannelCount();
-                    for (int i = 0; i < widthPx; ++i)
+                    const double binLength   = std::max(1.0, floor(framesPerPx + 0.5));
+                    const double scale       = 1.0 / waveform->getPeak();
+                    for (size_t i = 0; i < widthPx; ++i)
                     {
-                        const int binBegin_ = floor(t1 * soundBuffer->getSampleRate() + i * framesPerPx);
-                        const int binBegin  = std::max(0, std::min(framesTotal - 1, binBegin_));
-                        const int binEnd    = std::max(0, std::min(framesTotal - 1, binBegin_ + binLength - 1));
-                        bTime[i]  =  t1 + i * (t2 - t1) / static_cast<double>(widthPx - 1);
-                        byLow[i]  =  std::numeric_limits<double>::infinity();
-                        byHigh[i] = -std::numeric_limits<double>::infinity();
-                        for (int j = binBegin; j <= binEnd; ++j)
-                        {
-                            const int j1 = j * soundBuffer->getChannelCount();
-                            double value = samples->at(j1);
-                            byLow[i]     = std::min(byLow[i], value);
-                            byHigh[i]    = std::max(byHigh[i], value);
-                        }
+                        const double binBegin = std::max(0.0, floor(t1 * soundBuffer->getSampleRate() + i * framesPerPx));
+                        const auto   range    = waveform->query(static_cast<uint64_t>(binBegin),
+                                                                static_cast<uint64_t>(binBegin + binLength));
+                        bTime[i]  = t1 + i * (t2 - t1) / static_cast<double>(widthPx - 1);
+                        byLow[i]  = range.min * scale;
+                        byHigh[i] = range.max * scale;
                     }
                     // clang-format on
                 }
@@ -406,24 +448,48 @@ void LiveCharting::renderAudioWindow()
                 ImPlot::PlotLine("##DummyPointsForFitting", dummyX, dummyY, 4);
             }
 
+            // Only the markers inside the X limits are drawn, at most one per pixel column, in one call per colour.
+            static std::vector<double> markers;
+            if (beatAnalysis)
+            {
+                cullToPlot(beatAnalysis->beats, markers);
+                ImPlot::SetNextLineStyle(ImVec4(0, 1, 1, 0.35f));
+                ImPlot::PlotInfLines("##DetectedBeat", markers.data(), static_cast<int>(markers.size()));
+            }
             const auto& tiles = game->level.tiles;
-            for (size_t i = 0; i < tiles.size(); ++i)
+            cullToPlot(tiles | std::views::transform(&AdoCpp::Tile::seconds), markers);
+            ImPlot::SetNextLineStyle(ImVec4(1, 1, 0, 1));
+            ImPlot::PlotInfLines("##TileSecond", markers.data(), static_cast<int>(markers.size()));
+            if (game->activeTileIndex && *game->activeTileIndex < tiles.size())
             {
-                const auto& tile = tiles[i];
-                if (game->activeTileIndex && *game->activeTileIndex == i)
-                {
-                    ImPlot::TagX(tile.seconds, ImVec4(0, 1, 0, 1));
-                    ImPlot::SetNextLineStyle(ImVec4(0, 1, 0, 1));
-                }
-                else
-                    ImPlot::SetNextLineStyle(ImVec4(1, 1, 0, 1));
-                ImPlot::PlotInfLines("##TileSecond", &tile.seconds, 1);
+                const double activeSeconds = tiles[*game->activeTileIndex].seconds;
+                ImPlot::TagX(activeSeconds, ImVec4(0, 1, 0, 1));
+                ImPlot::SetNextLineStyle(ImVec4(0, 1, 0, 1));
+                ImPlot::PlotInfLines("##TileSecond", &activeSeconds, 1);
             }
             ImPlot::DragLineX(114514, &seconds, ImVec4(1, 0, 0, 1));
             ImPlot::TagX(seconds, ImVec4(1, 0, 0, 1));
+            timeRange = ImPlot::GetPlotLimits().X;
 
             ImPlot::EndPlot();
         }
+        static int fftSizeIndex = 2;
+        if (spectrogram && timeRange.Size() > 0 &&
+            ImPlot::BeginPlot("##Spectrogram", ImVec2(-1, ImGui::GetFontSize() * 8),
+                              ImPlotFlags_NoInputs | ImPlotFlags_NoLegend | ImPlotFlags_NoMenus))
+        {
+            // Follows the time range of the oscillogram above.
+            ImPlot::SetupAxes(nullptr, nullptr, ImPlotAxisFlags_NoDecorations, ImPlotAxisFlags_NoDecorations);
+            ImPlot::SetupAxisLimits(ImAxis_X1, timeRange.Min, timeRange.Max, ImPlotCond_Always);
+            ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1, ImPlotCond_Always);
+            const unsigned fftSize = 512u << fftSizeIndex;
+            for (const auto& tile : spectrogram->visibleTiles(timeRange.Min, timeRange.Max, fftSize, fftSize / 4))
+                ImPlot::PlotImage("##SpectrogramTile", static_cast<ImTextureID>(tile.texture->getNativeHandle()),
+                                  ImPlotPoint(tile.begin, 0), ImPlotPoint(tile.end, 1));
+            ImPlot::SetNextLineStyle(ImVec4(1, 0, 0, 1));
+            ImPlot::PlotInfLines("##Seconds", &seconds, 1);
+            ImPlot::EndPlot();
+        }
         static bool play = false, musicPlayed = false;
         if (ImGui::Button(play ? " " ICON_FA_PAUSE " Pause" : " " ICON_FA_PLAY " Play"))
         {
@@ -436,17 +502,56 @@ void LiveCharting::renderAudioWindow()
             {
                 music->stop();
             }
+            if (game->hitsoundStream)
+            {
+                if (play)
+                    game->hitsoundStream->setTiles(game->level.tiles);
+                else
+                    game->hitsoundStream->stop();
+            }
         }
+        // Live hitsounds are mixed into the music by the hitsound stream, which then plays the music and keeps the
+        // time. Without music, they follow the timer.
+        const bool mixHitsounds = game->config.liveHitsound && game->hitsoundStream && game->hitsoundStream->hasMusic();
         if (play)
         {
-            seconds += spareClock.restart().asSeconds();
+            if (mixHitsounds && musicPlayed && game->hitsoundStream->getStatus() == sf::SoundSource::Status::Playing)
+                seconds = game->hitsoundStream->getPlayingOffset().asSeconds(), spareClock.restart();
+            else
+                seconds += spareClock.restart().asSeconds();
+            if (game->config.liveHitsound && game->hitsoundStream && !game->hitsoundStream->hasMusic())
+                game->hitsoundStream->sync(seconds);
         }
         if (play && music && !musicPlayed)
         {
             musicPlayed = true;
-            if (seconds > 0)
-                music->setPlayingOffset(sf::seconds(seconds));
-            music->play();
+            if (mixHitsounds)
+            {
+                if (seconds > 0)
+                    game->hitsoundStream->setPlayingOffset(sf::seconds(seconds));
+                game->hitsoundStream->play();
+            }
+            else
+            {
+                if (seconds > 0)
+                    music->setPlayingOffset(sf::seconds(seconds));
+                music->play();
+            }
+        }
+        if (spectrogram)
+        {
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(ImGui::GetFontSize() * 5);
+            ImGui::Combo("FFT Size", &fftSizeIndex, "512\0" "1024\0" "2048\0" "4096\0");
+        }
+        if (beatAnalysis && game->activeTileIndex && *game->activeTileIndex < game->level.tiles.size())
+        {
+            ImGui::SameLine();
+            const double tileSeconds = game->level.tiles[*game->activeTileIndex].seconds;
+            if (const auto onset = beatAnalysis->nearestOnset(tileSeconds, 0.1))
+                ImGui::Text("Nearest onset: %+.0f ms", (*onset - tileSeconds) * 1000);
+            else
+                ImGui::Text("No onset within 100 ms");
         }
     }
     ImGui::End();
@@ -690,6 +795,8 @@ void LiveCharting::parseUpdateLevel(const size_t floor) const
     game->level.update();
     game->tileSystem.parse();
     game->tileSystem.update();
+    if (game->hitsoundStream)
+        game->hitsoundStream->setTiles(game->level.tiles);
 }
 void LiveCharting::renderSSong() const
 {
@@ -701,6 +808,16 @@ void LiveCharting::renderSSong() const
     PUL0(ImGui::InputDouble("BPM##SongSettings", &settings.bpm, 0, 0, "%g"))
     PUL0(ImGui::InputDouble("Volume##SongSettings", &settings.volume, 0, 0, "%g"))
     PUL0(ImGui::InputDouble("Offset##SongSettings", &settings.offset, 0, 0, "%g"))
+    if (beatAnalysis)
+    {
+        ImGui::Text("Detected: %.2f BPM, %.0f ms", beatAnalysis->bpm, beatAnalysis->offset);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Apply##DetectedBeats"))
+        {
+            settings.bpm = beatAnalysis->bpm, settings.offset = beatAnalysis->offset;
+            parseUpdateLevel(0);
+        }
+    }
     PUL0(ImGui::InputDouble("Pitch##SongSettings", &settings.pitch, 0, 0, "%g"))
     PUL0(comboBox("Hitsound##SongSettings", &settings.hitsound, AdoCpp::cstrHitsound))
     PUL0(ImGui::InputDouble("Hitsound Volume##SongSettings", &settings.hitsoundVolume, 0, 0, "%g"))
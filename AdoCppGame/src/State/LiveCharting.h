@@ -1,5 +1,9 @@
 #pragma once
+#include "BeatDetection.h"
+#include "Loading.h"
+#include "Spectrogram.h"
 #include "State.h"
+#include "Waveform.h"
 
 class LiveCharting final : public State
 {
@@ -48,9 +52,18 @@ private:
     double seconds{}, beat{};
     sf::Clock spareClock;
     double spareClockOffset{};
-    std::optional<sf::SoundBuffer> soundBuffer;
+    struct LoadedMusic
+    {
+        std::unique_ptr<sf::SoundBuffer> soundBuffer; // Boxed so the waveform's sample pointer survives moves.
+        WaveformPyramid waveform;
+        BeatAnalysis beatAnalysis;
+    };
+    LoadTask<LoadedMusic> musicLoad; // Decoded in the background after init().
+    std::unique_ptr<sf::SoundBuffer> soundBuffer;
+    std::optional<WaveformPyramid> waveform;
+    std::optional<BeatAnalysis> beatAnalysis;
+    std::unique_ptr<Spectrogram> spectrogram; // Reads soundBuffer, so it is declared after it.
     std::optional<sf::Sound> music;
-    std::optional<std::vector<double>> samples;
     bool render_needToUpdateOscillogram{};
     bool dragging{};
 };
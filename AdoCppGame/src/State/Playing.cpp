@@ -1,4 +1,6 @@
 #include "Playing.h"
+#include <algorithm>
+#include <cmath>
 #include <imgui-SFML.h>
 #include <imgui.h>
 
@@ -33,7 +35,7 @@ void StatePlaying::init(Game* _game)
 
     game->tileSystem.setActiveTileIndex(std::nullopt);
 
-    keyInputCnt = 0;
+    pressTimes.clear();
     waiting = true;
     if (game->activeTileIndex.value_or(0) == 0)
     {
@@ -48,8 +50,19 @@ void StatePlaying::init(Game* _game)
         beat = game->level.tiles[playerTileIndex].beat - game->level.settings.countdownTicks;
         seconds = game->level.beat2seconds(beat);
     }
+    // A headless run starts right away, as if the first key had been pressed.
+    if (game->headless)
+        pressTimes.push_back(seconds);
     game->window.setKeyRepeatEnabled(false);
     isMusicPlayed = false;
+    // Live hitsounds are mixed into the music they follow; a music file with baked hitsounds needs none.
+    if (game->hitsoundStream)
+    {
+        if (!game->config.liveHitsound || game->musicPath != game->origMusicPath || !musicPlayable() ||
+            !game->hitsoundStream->openFromFile(game->musicPath))
+            game->hitsoundStream->close();
+        game->hitsoundStream->setTiles(game->level.tiles);
+    }
 
     for (auto& hitCount : hitCounts)
         hitCount = 0;
@@ -58,21 +71,25 @@ void StatePlaying::init(Game* _game)
 void StatePlaying::cleanup()
 {
     if (musicPlayable())
-        game->music.stop();
+        musicStream().stop();
+    else if (game->hitsoundStream)
+        game->hitsoundStream->stop();
     game->window.setKeyRepeatEnabled(true);
 }
 
 void StatePlaying::pause()
 {
     if (musicPlayable())
-        game->music.pause();
+        musicStream().pause();
+    else if (game->hitsoundStream)
+        game->hitsoundStream->stop();
     game->window.setKeyRepeatEnabled(true);
 }
 
 void StatePlaying::resume()
 {
-    if (musicPlayable() && game->music.getStatus() == sf::Music::Status::Paused)
-        game->music.play();
+    if (musicPlayable() && musicStream().getStatus() == sf::SoundSource::Status::Paused)
+        musicStream().play();
     game->window.setKeyRepeatEnabled(false);
 }
 
@@ -91,10 +108,11 @@ void StatePlaying::handleEvent(const sf::Event event)
             {
                 if (scan == keyPressed->scancode)
                 {
-                    keyInputCnt++;
+                    const double pressTime = secondsNow();
+                    pressTimes.push_back(pressTime);
                     std::optional<AdoCpp::HitMargin> hitMargin;
                     if (playerTileIndex == 0 &&
-                        game->level.getHitMargin(playerTileIndex + 1, seconds, game->config.difficulty) ==
+                        game->level.getHitMargin(playerTileIndex + 1, pressTime, game->config.difficulty) ==
                             AdoCpp::HitMargin::TooEarly)
                         hitMargin = std::nullopt;
                     else
@@ -105,15 +123,15 @@ void StatePlaying::handleEvent(const sf::Event event)
                             if (playerTileIndex + cnt >= game->level.tiles.size())
                                 hitMargin = std::nullopt;
                             else if (!hitMargin || hitMargin && *hitMargin != AdoCpp::HitMargin::TooEarly)
-                                hitMargin =
-                                    game->level.getHitMargin(playerTileIndex + cnt, seconds, game->config.difficulty);
+                                hitMargin = game->level.getHitMargin(playerTileIndex + cnt, pressTime,
+                                                                     game->config.difficulty);
                             cnt++;
                         }
-                        while (cnt <= keyInputCnt);
+                        while (cnt <= pressTimes.size());
                     }
                     const bool needToBlock = !keyViewerSystem.press(scan, hitMargin);
                     if (needToBlock && game->config.blockKeyboardChatter)
-                        keyInputCnt--; // keyboardChatterBlocker
+                        pressTimes.pop_back(); // keyboardChatterBlocker
                     break;
                 }
             }
@@ -132,13 +150,14 @@ void StatePlaying::update()
 
     // ReSharper disable CppFunctionalStyleCast
     // Time
+    const bool wasWaiting = waiting;
     if (game->config.syncWithMusic)
     {
-        if (waiting && keyInputCnt > 0)
+        if (waiting && !pressTimes.empty())
         {
             // Start the music/timer
             waiting = false;
-            keyInputCnt--;
+            pressTimes.erase(pressTimes.begin());
 
             spareClock.restart();
             if (game->activeTileIndex.value_or(0) != 0)
@@ -148,17 +167,18 @@ void StatePlaying::update()
                     game->config.inputOffset / 1000;
 
                 if (musicPlayable())
-                    game->music.setPlayingOffset(sf::seconds(std::max(0.f, beginTimer)));
+                    musicStream().setPlayingOffset(sf::seconds(std::max(0.f, beginTimer)));
                 else
                     spareClockOffset =
                         game->level.beat2seconds(tiles[*game->activeTileIndex].beat) - game->config.inputOffset / 1000;
 
                 if (musicPlayable())
-                    seconds = game->music.getPlayingOffset().asSeconds() + game->config.inputOffset / 1000;
+                    seconds = musicStream().getPlayingOffset().asSeconds() + game->config.inputOffset / 1000;
                 else
                     seconds =
                         spareClock.getElapsedTime().asSeconds() + game->config.inputOffset / 1000 + spareClockOffset;
-                beat = game->level.seconds2beat(seconds), currentTileIndex = game->level.getFloorByBeat(beat);
+                beat = game->level.seconds2beat(seconds),
+                currentTileIndex = game->level.getFloorByBeat(beat, currentTileIndex);
             }
             else
             {
@@ -173,11 +193,11 @@ void StatePlaying::update()
     }
     else
     {
-        if (waiting && keyInputCnt > 0)
+        if (waiting && !pressTimes.empty())
         {
             // Start the music/timer
             waiting = false;
-            keyInputCnt--;
+            pressTimes.erase(pressTimes.begin());
 
             if (game->activeTileIndex.value_or(0) != 0)
             {
@@ -185,7 +205,7 @@ void StatePlaying::update()
                     - game->level.settings.countdownTicks);
                 const float beginTimer = static_cast<float>(seconds) - game->config.inputOffset / 1000;
                 if (musicPlayable())
-                    game->music.setPlayingOffset(sf::seconds(std::max(0.f, beginTimer)));
+                    musicStream().setPlayingOffset(sf::seconds(std::max(0.f, beginTimer)));
             }
             else
                 seconds =
@@ -193,71 +213,33 @@ void StatePlaying::update()
             spareClock.restart();
         }
     }
+    const bool started = wasWaiting && !waiting;
     updateTime();
+    if (started)
+        simSeconds = seconds;
+
+    // Without music, live hitsounds follow the timer instead.
+    if (!waiting && game->hitsoundStream && game->config.liveHitsound && !musicPlayable())
+        game->hitsoundStream->sync(seconds - game->config.inputOffset / 1000);
 
     // Update the level
-    game->level.update(seconds);
+    {
+        const ProfileZone zone(game->profiler, Profiler::Zone::LevelUpdate);
+        game->level.update(seconds);
+    }
 
-    // Judgement
+    // Judgement and the camera
     if (!waiting)
     {
-        // Process
-        if (game->autoplay)
-        {
-            keyInputCnt = 0;
-            for (size_t i = playerTileIndex; i < currentTileIndex; i++)
-            {
-                if (tiles[i + 1].angle.deg() != 999)
-                    keyInputCnt++;
-            }
-        }
-        // Judgement
-        using enum AdoCpp::HitMargin;
-        while (playerTileIndex < tiles.size() - 1 && keyInputCnt-- > 0)
-        {
-            playerTileIndex++;
-            const auto [p, lep, vle] = game->level.getTimingBoundary(playerTileIndex, game->config.difficulty);
-            const double timing = game->level.getTiming(playerTileIndex, seconds),
-                         x = std::min(65.0 / 2, std::max(-65.0 / 2, timing / vle * 65.0 / 2.0));
-            const AdoCpp::HitMargin hitMargin =
-                game->level.getHitMargin(playerTileIndex, seconds, game->config.difficulty);
-            if (hitMargin == TooEarly)
-            {
-                playerTileIndex--;
-                if (playerTileIndex == 0)
-                    break;
-                AdoCpp::Vector2lf pos;
-                if (AdoCpp::Level::isFirePlanetStatic(playerTileIndex))
-                    pos = game->level.getPlanetsPos(playerTileIndex, seconds).second;
-                else
-                    pos = game->level.getPlanetsPos(playerTileIndex, seconds).first;
-                hitTextSystem.addHitText(seconds, hitMargin, {float(pos.x), float(pos.y)});
-            }
-            else
-            {
-                if (playerTileIndex != tiles.size() - 1 && tiles[playerTileIndex + 1].angle.deg() == 999)
-                    playerTileIndex++;
-                hitTextSystem.addHitText(
-                    seconds, hitMargin, {float(tiles[playerTileIndex].pos.c.x), float(tiles[playerTileIndex].pos.c.y)});
-            }
-            hitCounts[static_cast<int>(hitMargin)]++;
-            hitErrorMeterSystem.addTick(seconds, hitMargin, x);
-        }
-        keyInputCnt = 0;
-        // "Too late" judgement
-        while (playerTileIndex < tiles.size() - 1 &&
-               game->level.getHitMargin(playerTileIndex + 1, seconds, game->config.difficulty) == TooLate)
-        {
-            playerTileIndex++;
-            if (tiles[playerTileIndex].angle.deg() != 999)
-            {
-                hitTextSystem.addHitText(seconds, TooLate,
-                                         {static_cast<float>(tiles[playerTileIndex].pos.c.x),
-                                          static_cast<float>(tiles[playerTileIndex].pos.c.y)});
-                hitErrorMeterSystem.addTick(seconds, TooLate, 65.0 / 2);
-                hitCounts[static_cast<int>(TooLate)]++;
-            }
-        }
+        // The simulation catches up with the clock in fixed ticks; the remainder is interpolated below.
+        const ProfileZone zone(game->profiler, Profiler::Zone::Judgement);
+        while (simSeconds + tickSeconds <= seconds)
+            tick();
+    }
+    else
+    {
+        game->camera.update(game->level, seconds, playerTileIndex);
+        cameraState = {game->camera.position, game->camera.rotation, game->camera.zoom}, lastCameraState = cameraState;
     }
 
     // Update planets' positions
@@ -278,7 +260,10 @@ void StatePlaying::update()
     }
 
     // Update Systems
-    game->tileSystem.update();
+    {
+        const ProfileZone zone(game->profiler, Profiler::Zone::TileSystemUpdate);
+        game->tileSystem.update();
+    }
     hitTextSystem.update(seconds);
     hitErrorMeterSystem.update(seconds);
     hitErrorMeterSystem.setPosition({float(game->windowSize.x) / 2, float(game->windowSize.y) - 100});
@@ -288,9 +273,10 @@ void StatePlaying::update()
     countDownSystem.update(game->level, beat);
 
     // Update the camera
-    game->camera.update(game->level, seconds, playerTileIndex);
-    const auto pos = game->camera.position;
-    const auto rot = game->camera.rotation, zoom = game->camera.zoom;
+    const double alpha = waiting ? 1 : (seconds - simSeconds) / tickSeconds;
+    const auto pos = lastCameraState.position + (cameraState.position - lastCameraState.position) * alpha;
+    const auto rot = std::lerp(lastCameraState.rotation, cameraState.rotation, alpha),
+               zoom = std::lerp(lastCameraState.zoom, cameraState.zoom, alpha);
     game->view.setCenter({float(pos.x), float(pos.y)});
     game->view.setRotation(sf::degrees(float(rot)));
     const auto w = float(game->windowSize.x), h = float(game->windowSize.y);
@@ -300,61 +286,177 @@ void StatePlaying::update()
     game->view.setSize({w / (w + h) * 16 * game->zoom.x, -h / (w + h) * 16 * game->zoom.y});
     // ReSharper restore CppFunctionalStyleCast
 }
+void StatePlaying::tick()
+{
+    auto& tiles = game->level.tiles;
+    simSeconds += tickSeconds;
+
+    // Process
+    if (game->autoplay)
+    {
+        // Autoplay presses exactly at the tiles' times.
+        pressTimes.clear();
+        const size_t floor = game->level.getFloorBySeconds(simSeconds, playerTileIndex);
+        for (size_t i = playerTileIndex; i < floor; i++)
+        {
+            if (tiles[i + 1].angle.deg() != 999)
+                pressTimes.push_back(tiles[i + 1].seconds);
+        }
+    }
+
+    // Judgement
+    // Every press is judged at its own time, in order, so the result does not depend on the tick or frame length.
+    std::ranges::sort(pressTimes);
+    const auto due = std::ranges::upper_bound(pressTimes, simSeconds);
+    for (auto it = pressTimes.begin(); it != due; ++it)
+        judgeTooLate(*it), judgePress(*it);
+    pressTimes.erase(pressTimes.begin(), due);
+    judgeTooLate(simSeconds);
+
+    // Camera
+    game->camera.update(game->level, simSeconds, playerTileIndex);
+    lastCameraState = cameraState, cameraState = {game->camera.position, game->camera.rotation, game->camera.zoom};
+}
+void StatePlaying::judgePress(const double pressTime)
+{
+    auto& tiles = game->level.tiles;
+    if (playerTileIndex >= tiles.size() - 1)
+        return;
+    // ReSharper disable CppFunctionalStyleCast
+    using enum AdoCpp::HitMargin;
+    playerTileIndex++;
+    const auto [p, lep, vle] = game->level.getTimingBoundary(playerTileIndex, game->config.difficulty);
+    const double timing = game->level.getTiming(playerTileIndex, pressTime),
+                 x = std::min(65.0 / 2, std::max(-65.0 / 2, timing / vle * 65.0 / 2.0));
+    const AdoCpp::HitMargin hitMargin = game->level.getHitMargin(playerTileIndex, pressTime, game->config.difficulty);
+    if (hitMargin == TooEarly)
+    {
+        playerTileIndex--;
+        if (playerTileIndex == 0)
+            return;
+        AdoCpp::Vector2lf pos;
+        if (AdoCpp::Level::isFirePlanetStatic(playerTileIndex))
+            pos = game->level.getPlanetsPos(playerTileIndex, pressTime).second;
+        else
+            pos = game->level.getPlanetsPos(playerTileIndex, pressTime).first;
+        hitTextSystem.addHitText(pressTime, hitMargin, {float(pos.x), float(pos.y)});
+    }
+    else
+    {
+        if (playerTileIndex != tiles.size() - 1 && tiles[playerTileIndex + 1].angle.deg() == 999)
+            playerTileIndex++;
+        hitTextSystem.addHitText(pressTime, hitMargin,
+                                 {float(tiles[playerTileIndex].pos.c.x), float(tiles[playerTileIndex].pos.c.y)});
+    }
+    hitCounts[static_cast<int>(hitMargin)]++;
+    hitErrorMeterSystem.addTick(pressTime, hitMargin, x);
+    // ReSharper restore CppFunctionalStyleCast
+}
+void StatePlaying::judgeTooLate(const double time)
+{
+    auto& tiles = game->level.tiles;
+    using enum AdoCpp::HitMargin;
+    while (playerTileIndex < tiles.size() - 1 &&
+           game->level.getHitMargin(playerTileIndex + 1, time, game->config.difficulty) == TooLate)
+    {
+        playerTileIndex++;
+        if (tiles[playerTileIndex].angle.deg() != 999)
+        {
+            hitTextSystem.addHitText(time, TooLate,
+                                     {static_cast<float>(tiles[playerTileIndex].pos.c.x),
+                                      static_cast<float>(tiles[playerTileIndex].pos.c.y)});
+            hitErrorMeterSystem.addTick(time, TooLate, 65.0 / 2);
+            hitCounts[static_cast<int>(TooLate)]++;
+        }
+    }
+}
+double StatePlaying::secondsNow() const
+{
+    // The same clock as updateTime, read without advancing it.
+    if (waiting)
+        return seconds;
+    if (game->headless)
+        return seconds;
+    if (game->config.syncWithMusic)
+    {
+        if (!musicPlayable())
+            return spareClock.getElapsedTime().asSeconds() + game->config.inputOffset / 1000 + spareClockOffset;
+        if (musicStream().getStatus() == sf::SoundSource::Status::Stopped)
+            return seconds + spareClock.getElapsedTime().asSeconds();
+        return musicStream().getPlayingOffset().asSeconds() + game->config.inputOffset / 1000;
+    }
+    return seconds + spareClock.getElapsedTime().asSeconds();
+}
 void StatePlaying::updateTime()
 {
     if (waiting)
         return;
+    if (game->headless)
+    {
+        // Headless runs follow the fixed timestep instead of the clock or the music.
+        seconds += game->deltaTime.asSeconds();
+        beat = game->level.seconds2beat(seconds), currentTileIndex = game->level.getFloorByBeat(beat, currentTileIndex);
+        return;
+    }
     if (game->config.syncWithMusic)
     {
         if (musicPlayable())
         {
-            if (game->music.getStatus() == sf::Music::Status::Stopped)
+            if (musicStream().getStatus() == sf::SoundSource::Status::Stopped)
             {
                 seconds += spareClock.restart().asSeconds();
                 if (!isMusicPlayed && seconds >= game->config.inputOffset / 1000)
-                    game->music.play(), spareClock.reset(), isMusicPlayed = true;
+                    musicStream().play(), spareClock.reset(), isMusicPlayed = true;
             }
             else
-                seconds = game->music.getPlayingOffset().asSeconds() + game->config.inputOffset / 1000;
+                seconds = musicStream().getPlayingOffset().asSeconds() + game->config.inputOffset / 1000;
         }
         else
             seconds = spareClock.getElapsedTime().asSeconds() + game->config.inputOffset / 1000 + spareClockOffset;
-        beat = game->level.seconds2beat(seconds), currentTileIndex = game->level.getFloorByBeat(beat);
+        beat = game->level.seconds2beat(seconds), currentTileIndex = game->level.getFloorByBeat(beat, currentTileIndex);
     }
     else
     {
         seconds += spareClock.restart().asSeconds();
-        beat = game->level.seconds2beat(seconds), currentTileIndex = game->level.getFloorByBeat(beat);
-        if (musicPlayable() && game->music.getStatus() == sf::Music::Status::Stopped && !isMusicPlayed &&
+        beat = game->level.seconds2beat(seconds), currentTileIndex = game->level.getFloorByBeat(beat, currentTileIndex);
+        if (musicPlayable() && musicStream().getStatus() == sf::SoundSource::Status::Stopped && !isMusicPlayed &&
             seconds >= game->config.inputOffset / 1000)
-            game->music.play(), isMusicPlayed = true;
+            musicStream().play(), isMusicPlayed = true;
     }
 }
 
 void StatePlaying::render()
 {
     auto& tiles = game->level.tiles;
+    auto& target = game->renderTarget();
 
     // render the world
-    game->window.setView(game->view);
+    target.setView(game->view);
 
-    game->window.draw(game->tileSystem);
+    {
+        const ProfileZone zone(game->profiler, Profiler::Zone::TileSystemDraw);
+        target.draw(game->tileSystem);
+    }
 
     if (!waiting || AdoCpp::Level::isFirePlanetStatic(playerTileIndex))
-        game->window.draw(planet1);
+        target.draw(planet1);
     if (!waiting || !AdoCpp::Level::isFirePlanetStatic(playerTileIndex))
-        game->window.draw(planet2);
+        target.draw(planet2);
 
-    game->window.draw(hitTextSystem);
+    target.draw(hitTextSystem);
 
     // render the GUI
-    sf::View defaultView = game->window.getDefaultView();
+    sf::View defaultView = target.getDefaultView();
     defaultView.setSize(sf::Vector2f(game->windowSize));
     defaultView.setCenter(sf::Vector2f(game->windowSize) / 2.f);
-    game->window.setView(defaultView);
-    game->window.draw(hitErrorMeterSystem);
-    game->window.draw(keyViewerSystem);
-    game->window.draw(countDownSystem);
+    target.setView(defaultView);
+    target.draw(hitErrorMeterSystem);
+    target.draw(keyViewerSystem);
+    target.draw(countDownSystem);
+
+    // ImGui needs a window, so the text overlays are window-only.
+    if (game->headless)
+        return;
 
     static constexpr ImGuiWindowFlags flags = ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
         ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoBackground |
@@ -364,7 +466,8 @@ void StatePlaying::render()
     ImGui::SetNextWindowPos(ImVec2(ImGui::GetFontSize(), ImGui::GetFontSize()));
     if (ImGui::Begin("LeftText", nullptr, flags))
     {
-        ImGui::Text("FPS: %.0f avg, %.0f min, %.0f max", game->avgFps, game->minFps, game->maxFps);
+        const auto [avgFps, minFps, maxFps] = game->profiler.fpsStats();
+        ImGui::Text("FPS: %.0f avg, %.0f min, %.0f max", avgFps, minFps, maxFps);
         static double progress, bpm, kps;
         progress = 100 * static_cast<double>(playerTileIndex) / static_cast<double>(tiles.size() - 1);
         bpm = game->level.getBpmByBeat(game->level.tiles[playerTileIndex].beat);
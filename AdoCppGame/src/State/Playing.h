@@ -23,12 +23,48 @@ public:
     void updateTime();
     void render() override;
 
+    /**
+     * Advances judgement and the camera by one fixed tick of tickSeconds. Key presses that fall into the tick are
+     * judged at their own timestamps.
+     */
+    void tick();
+
     static StatePlaying* instance() { return &m_statePlaying; }
 
+    /**
+     * Whether the player has reached the last tile and the level has played out for one more second.
+     */
+    bool finished() const
+    {
+        return !waiting && playerTileIndex == game->level.tiles.size() - 1 &&
+            seconds > game->level.tiles.back().seconds + 1;
+    }
+    double getSeconds() const { return seconds; }
+    const std::array<size_t, 7>& getHitCounts() const { return hitCounts; }
+
+    /**
+     * The length of one simulation tick. Judgement and the camera always advance by this step, so they behave the
+     * same at any framerate.
+     */
+    static constexpr double tickSeconds = 1.0 / 240;
+
 protected:
     StatePlaying() = default;
 
     bool musicPlayable() const { return game->music.getDuration().asMilliseconds() != 0; }
+    /**
+     * The stream that plays the music: the hitsound stream when it mixes live hitsounds into the music, game->music
+     * otherwise.
+     */
+    sf::SoundStream& musicStream() const
+    {
+        if (game->hitsoundStream && game->hitsoundStream->hasMusic())
+            return *game->hitsoundStream;
+        return game->music;
+    }
+    double secondsNow() const;
+    void judgePress(double pressTime);
+    void judgeTooLate(double time);
 
 private:
     static StatePlaying m_statePlaying;
@@ -39,8 +75,14 @@ private:
     HitErrorMeterSystem hitErrorMeterSystem;
     KeyViewerSystem keyViewerSystem;
     CountDownSystem countDownSystem{fontHts};
-    int keyInputCnt{};
+    std::vector<double> pressTimes; // The level time of every key press that has not been judged yet.
     double seconds{}, beat{};
+    double simSeconds{}; // The level time of the last tick, at most tickSeconds behind seconds.
+    struct CameraState
+    {
+        AdoCpp::Vector2lf position;
+        double rotation{}, zoom{};
+    } lastCameraState, cameraState; // The camera before and after the last tick, for interpolation.
     sf::Clock spareClock;
     double spareClockOffset{};
     bool waiting{};
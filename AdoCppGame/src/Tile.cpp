@@ -1,5 +1,8 @@
 #include "Tile.h"
+#include <cassert>
+#include <initializer_list>
 #include <map>
+#include <memory>
 // #include <boost/geometry.hpp>
 // #include <earcut.hpp>
 
@@ -57,31 +60,108 @@ static bool pointIsInsideTriangle(const std::vector<sf::Vector2f>& points, const
     return a >= 0.l && a <= 1.l && b >= 0.l && b <= 1.l && c >= 0.l && c <= 1.l;
 }
 
-// Thanks for StArray's code
-static void createCircle(const sf::Vector3f center, const float r, std::vector<sf::Vector3f>& vertices,
-                         std::vector<size_t>& m_triangles, const uint32_t resolution = 32)
+/**
+ * Writes triangles straight into the destination vertex array.
+ * The array is grown to a fixed capacity (see tileMeshCapacity), so rebuilding a mesh reuses its storage.
+ */
+class TriangleWriter
 {
-    const size_t centerIndex = vertices.size();
-    vertices.push_back(center);
-
-    for (int i = 0; i < resolution; i++)
+public:
+    TriangleWriter(sf::VertexArray& vertices, const size_t capacity) : m_vertices(vertices)
     {
-        const float angle = 2.f * PI * static_cast<float>(i) / static_cast<float>(resolution);
-        sf::Vector3f vertex = sf::Vector3f(std::cos(angle) * r, std::sin(angle) * r, 0) + center;
-        vertices.push_back(vertex);
+        m_vertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+        m_vertices.resize(capacity);
     }
-
-    for (int i = 1; i < resolution; i++)
+    void triangle(const sf::Vector2f a, const sf::Vector2f b, const sf::Vector2f c)
+    {
+        assert(m_count + 3 <= m_vertices.getVertexCount() && "TriangleWriter capacity exceeded");
+        m_vertices[m_count++] = sf::Vertex{a};
+        m_vertices[m_count++] = sf::Vertex{b};
+        m_vertices[m_count++] = sf::Vertex{c};
+    }
+    template <size_t N>
+    void triangles(const sf::Vector2f (&points)[N], const std::initializer_list<uint8_t> indices)
     {
-        m_triangles.push_back(centerIndex);
-        m_triangles.push_back(centerIndex + i);
-        m_triangles.push_back(centerIndex + i + 1);
+        assert(indices.size() % 3 == 0);
+        for (auto it = indices.begin(); it != indices.end(); it += 3)
+            triangle(points[it[0]], points[it[1]], points[it[2]]);
     }
+    /**
+     * Shrink the array to the written vertices (the capacity of the underlying storage is kept).
+     */
+    void finish() const { m_vertices.resize(m_count); }
+
+private:
+    sf::VertexArray& m_vertices;
+    size_t m_count{};
+};
+
+/**
+ * The maximum number of vertices createTileMesh/createMidSpinMesh write into each of the two arrays:
+ * a circle (one triangle per step) plus at most eight triangles of joint and arms.
+ */
+static constexpr size_t tileMeshCapacity(const uint32_t interpolationLevel) { return 3 * interpolationLevel + 24; }
 
+// Thanks for StArray's code
+static void createCircle(TriangleWriter& writer, const sf::Vector2f center, const float r,
+                         const uint32_t resolution = 32)
+{
+    const auto point = [&](const uint32_t i)
+    {
+        const float angle = 2.f * PI * static_cast<float>(i) / static_cast<float>(resolution);
+        return sf::Vector2f(std::cos(angle) * r, std::sin(angle) * r) + center;
+    };
+    const sf::Vector2f first = point(0);
+    sf::Vector2f last = first;
+    for (uint32_t i = 1; i < resolution; i++)
+    {
+        const sf::Vector2f next = point(i);
+        writer.triangle(center, last, next);
+        last = next;
+    }
     // Closing the circle by connecting the last vertex to the first
-    m_triangles.push_back(centerIndex);
-    m_triangles.push_back(centerIndex + resolution);
-    m_triangles.push_back(centerIndex + 1);
+    writer.triangle(center, last, first);
+}
+
+// Thanks for StArray's code
+static void createArm(TriangleWriter& writer, const sf::Vector2f offset, const float width, const float length,
+                      const float m1, const float m2)
+{
+    const sf::Vector2f v[] = {
+        offset + sf::Vector2f(length * m1 + width * m2, length * m2 - width * m1),
+        offset + sf::Vector2f(length * m1 - width * m2, length * m2 + width * m1),
+        offset + sf::Vector2f(-width * m2, width * m1),
+        offset + sf::Vector2f(width * m2, -width * m1),
+    };
+    writer.triangles(v, {0, 1, 2, 2, 3, 0});
+}
+
+// Thanks for StArray's code
+static void createRoundedJoint(TriangleWriter& writer, const float circlex, const float circley, const float radius,
+                               const float width, const float (&a)[2])
+{
+    const sf::Vector2f v[] = {
+        {-radius * std::sin(a[1]) + circlex, radius * std::cos(a[1]) + circley},
+        {circlex, circley},
+        {radius * std::sin(a[0]) + circlex, -radius * std::cos(a[0]) + circley},
+        {width * std::sin(a[0]), -width * std::cos(a[0])},
+        {},
+        {-width * std::sin(a[1]), width * std::cos(a[1])},
+    };
+    writer.triangles(v, {0, 1, 5, 4, 1, 5, 2, 3, 4, 1, 3, 4});
+}
+
+// Thanks for StArray's code
+static void createSharpJoint(TriangleWriter& writer, const float circlex, const float circley, const float width,
+                             const float (&a)[2])
+{
+    const sf::Vector2f v[] = {
+        {circlex, circley},
+        {width * std::sin(a[0]), -width * std::cos(a[0])},
+        {},
+        {-width * std::sin(a[1]), width * std::cos(a[1])},
+    };
+    writer.triangles(v, {0, 1, 2, 2, 3, 0});
 }
 
 // Thanks for StArray's code
@@ -92,8 +172,8 @@ static void createTileMesh(float width, float length, sf::Angle startAngle, sf::
                            sf::VertexArray& m_outlineVertices)
 {
     startAngle = startAngle.wrapUnsigned(), endAngle = endAngle.wrapUnsigned();
-    std::vector<sf::Vector3f> fillVertices, outlineVertices;
-    std::vector<size_t> fillTriangles, outlineTriangles;
+    const size_t capacity = tileMeshCapacity(m_interpolationLevel);
+    TriangleWriter fill(m_fillVertices, capacity), border(m_outlineVertices, capacity);
 
     // region basic process
     const float m11 = std::cos(startAngle.asRadians()), m12 = std::sin(startAngle.asRadians()),
@@ -139,53 +219,10 @@ static void createTileMesh(float width, float length, sf::Angle startAngle, sf::
         width += outline;
         length += outline;
         radius += outline;
-        createCircle(sf::Vector3f(circlex, circley, 0), radius, outlineVertices, outlineTriangles,
-                     m_interpolationLevel);
-        {
-            const size_t count = outlineVertices.size();
-            outlineVertices.emplace_back(-radius * std::sin(a[1]) + circlex, radius * std::cos(a[1]) + circley, 0);
-            outlineVertices.emplace_back(circlex, circley, 0);
-            outlineVertices.emplace_back(radius * std::sin(a[0]) + circlex, -radius * std::cos(a[0]) + circley, 0);
-            outlineVertices.emplace_back(width * std::sin(a[0]), -width * std::cos(a[0]), 0);
-            outlineVertices.emplace_back();
-            outlineVertices.emplace_back(-width * std::sin(a[1]), width * std::cos(a[1]), 0);
-            outlineTriangles.push_back(count);
-            outlineTriangles.push_back(count + 1);
-            outlineTriangles.push_back(count + 5);
-            outlineTriangles.push_back(count + 4);
-            outlineTriangles.push_back(count + 1);
-            outlineTriangles.push_back(count + 5);
-            outlineTriangles.push_back(count + 2);
-            outlineTriangles.push_back(count + 3);
-            outlineTriangles.push_back(count + 4);
-            outlineTriangles.push_back(count + 1);
-            outlineTriangles.push_back(count + 3);
-            outlineTriangles.push_back(count + 4);
-        }
-        {
-            const size_t count = outlineVertices.size();
-            outlineVertices.emplace_back(length * m11 + width * m12, length * m12 - width * m11, 0);
-            outlineVertices.emplace_back(length * m11 - width * m12, length * m12 + width * m11, 0);
-            outlineVertices.emplace_back(-width * m12, width * m11, 0);
-            outlineVertices.emplace_back(width * m12, -width * m11, 0);
-
-            outlineVertices.emplace_back(length * m21 + width * m22, length * m22 - width * m21, 0);
-            outlineVertices.emplace_back(length * m21 - width * m22, length * m22 + width * m21, 0);
-            outlineVertices.emplace_back(-width * m22, width * m21, 0);
-            outlineVertices.emplace_back(width * m22, -width * m21, 0);
-            outlineTriangles.push_back(count);
-            outlineTriangles.push_back(count + 1);
-            outlineTriangles.push_back(count + 2);
-            outlineTriangles.push_back(count + 2);
-            outlineTriangles.push_back(count + 3);
-            outlineTriangles.push_back(count);
-            outlineTriangles.push_back(count + 4);
-            outlineTriangles.push_back(count + 5);
-            outlineTriangles.push_back(count + 6);
-            outlineTriangles.push_back(count + 6);
-            outlineTriangles.push_back(count + 7);
-            outlineTriangles.push_back(count + 4);
-        }
+        createCircle(border, {circlex, circley}, radius, m_interpolationLevel);
+        createRoundedJoint(border, circlex, circley, radius, width, a);
+        createArm(border, {}, width, length, m11, m12);
+        createArm(border, {}, width, length, m21, m22);
         // endregion
         // region fill
         width -= outline * 2.f;
@@ -197,52 +234,10 @@ static void createTileMesh(float width, float length, sf::Angle startAngle, sf::
             circlex = -width / std::sin(angle / 2.f) * std::cos(mid);
             circley = -width / std::sin(angle / 2.f) * std::sin(mid);
         }
-        createCircle(sf::Vector3f(circlex, circley, 0), radius, fillVertices, fillTriangles, m_interpolationLevel);
-        {
-            const size_t count = fillVertices.size();
-            fillVertices.emplace_back(-radius * std::sin(a[1]) + circlex, radius * std::cos(a[1]) + circley, 0);
-            fillVertices.emplace_back(circlex, circley, 0);
-            fillVertices.emplace_back(radius * std::sin(a[0]) + circlex, -radius * std::cos(a[0]) + circley, 0);
-            fillVertices.emplace_back(width * std::sin(a[0]), -width * std::cos(a[0]), 0);
-            fillVertices.emplace_back();
-            fillVertices.emplace_back(-width * std::sin(a[1]), width * std::cos(a[1]), 0);
-            fillTriangles.push_back(count);
-            fillTriangles.push_back(count + 1);
-            fillTriangles.push_back(count + 5);
-            fillTriangles.push_back(count + 4);
-            fillTriangles.push_back(count + 1);
-            fillTriangles.push_back(count + 5);
-            fillTriangles.push_back(count + 2);
-            fillTriangles.push_back(count + 3);
-            fillTriangles.push_back(count + 4);
-            fillTriangles.push_back(count + 1);
-            fillTriangles.push_back(count + 3);
-            fillTriangles.push_back(count + 4);
-        }
-        {
-            const size_t count = fillVertices.size();
-            fillVertices.emplace_back(length * m11 + width * m12, length * m12 - width * m11, 0);
-            fillVertices.emplace_back(length * m11 - width * m12, length * m12 + width * m11, 0);
-            fillVertices.emplace_back(-width * m12, width * m11, 0);
-            fillVertices.emplace_back(width * m12, -width * m11, 0);
-
-            fillVertices.emplace_back(length * m21 + width * m22, length * m22 - width * m21, 0);
-            fillVertices.emplace_back(length * m21 - width * m22, length * m22 + width * m21, 0);
-            fillVertices.emplace_back(-width * m22, width * m21, 0);
-            fillVertices.emplace_back(width * m22, -width * m21, 0);
-            fillTriangles.push_back(count);
-            fillTriangles.push_back(count + 1);
-            fillTriangles.push_back(count + 2);
-            fillTriangles.push_back(count + 2);
-            fillTriangles.push_back(count + 3);
-            fillTriangles.push_back(count);
-            fillTriangles.push_back(count + 4);
-            fillTriangles.push_back(count + 5);
-            fillTriangles.push_back(count + 6);
-            fillTriangles.push_back(count + 6);
-            fillTriangles.push_back(count + 7);
-            fillTriangles.push_back(count + 4);
-        }
+        createCircle(fill, {circlex, circley}, radius, m_interpolationLevel);
+        createRoundedJoint(fill, circlex, circley, radius, width, a);
+        createArm(fill, {}, width, length, m11, m12);
+        createArm(fill, {}, width, length, m21, m22);
         // endregion
     }
     else if (angle > 0)
@@ -254,43 +249,9 @@ static void createTileMesh(float width, float length, sf::Angle startAngle, sf::
         float circlex = -width / std::sin(angle / 2.f) * std::cos(mid);
         float circley = -width / std::sin(angle / 2.f) * std::sin(mid);
 
-        {
-            constexpr size_t count = 0;
-            outlineVertices.emplace_back(circlex, circley, 0);
-            outlineVertices.emplace_back(width * std::sin(a[0]), -width * std::cos(a[0]), 0);
-            outlineVertices.emplace_back();
-            outlineVertices.emplace_back(-width * std::sin(a[1]), width * std::cos(a[1]), 0);
-            outlineTriangles.push_back(count);
-            outlineTriangles.push_back(count + 1);
-            outlineTriangles.push_back(count + 2);
-            outlineTriangles.push_back(count + 2);
-            outlineTriangles.push_back(count + 3);
-            outlineTriangles.push_back(count);
-        }
-        {
-            const size_t count = outlineVertices.size();
-            outlineVertices.emplace_back(length * m11 + width * m12, length * m12 - width * m11, 0);
-            outlineVertices.emplace_back(length * m11 - width * m12, length * m12 + width * m11, 0);
-            outlineVertices.emplace_back(-width * m12, width * m11, 0);
-            outlineVertices.emplace_back(width * m12, -width * m11, 0);
-
-            outlineVertices.emplace_back(length * m21 + width * m22, length * m22 - width * m21, 0);
-            outlineVertices.emplace_back(length * m21 - width * m22, length * m22 + width * m21, 0);
-            outlineVertices.emplace_back(-width * m22, width * m21, 0);
-            outlineVertices.emplace_back(width * m22, -width * m21, 0);
-            outlineTriangles.push_back(count);
-            outlineTriangles.push_back(count + 1);
-            outlineTriangles.push_back(count + 2);
-            outlineTriangles.push_back(count + 2);
-            outlineTriangles.push_back(count + 3);
-            outlineTriangles.push_back(count);
-            outlineTriangles.push_back(count + 4);
-            outlineTriangles.push_back(count + 5);
-            outlineTriangles.push_back(count + 6);
-            outlineTriangles.push_back(count + 6);
-            outlineTriangles.push_back(count + 7);
-            outlineTriangles.push_back(count + 4);
-        }
+        createSharpJoint(border, circlex, circley, width, a);
+        createArm(border, {}, width, length, m11, m12);
+        createArm(border, {}, width, length, m21, m22);
         // endregion
         // region fill
         width -= outline * 2.f;
@@ -299,43 +260,9 @@ static void createTileMesh(float width, float length, sf::Angle startAngle, sf::
         circlex = -width / std::sin(angle / 2.f) * std::cos(mid);
         circley = -width / std::sin(angle / 2.f) * std::sin(mid);
 
-        {
-            const size_t count = fillVertices.size();
-            fillVertices.emplace_back(circlex, circley, 0);
-            fillVertices.emplace_back(width * std::sin(a[0]), -width * std::cos(a[0]), 0);
-            fillVertices.emplace_back();
-            fillVertices.emplace_back(-width * std::sin(a[1]), width * std::cos(a[1]), 0);
-            fillTriangles.push_back(count);
-            fillTriangles.push_back(count + 1);
-            fillTriangles.push_back(count + 2);
-            fillTriangles.push_back(count + 2);
-            fillTriangles.push_back(count + 3);
-            fillTriangles.push_back(count);
-        }
-        {
-            const size_t count = fillVertices.size();
-            fillVertices.emplace_back(length * m11 + width * m12, length * m12 - width * m11, 0);
-            fillVertices.emplace_back(length * m11 - width * m12, length * m12 + width * m11, 0);
-            fillVertices.emplace_back(-width * m12, width * m11, 0);
-            fillVertices.emplace_back(width * m12, -width * m11, 0);
-
-            fillVertices.emplace_back(length * m21 + width * m22, length * m22 - width * m21, 0);
-            fillVertices.emplace_back(length * m21 - width * m22, length * m22 + width * m21, 0);
-            fillVertices.emplace_back(-width * m22, width * m21, 0);
-            fillVertices.emplace_back(width * m22, -width * m21, 0);
-            fillTriangles.push_back(count);
-            fillTriangles.push_back(count + 1);
-            fillTriangles.push_back(count + 2);
-            fillTriangles.push_back(count + 2);
-            fillTriangles.push_back(count + 3);
-            fillTriangles.push_back(count);
-            fillTriangles.push_back(count + 4);
-            fillTriangles.push_back(count + 5);
-            fillTriangles.push_back(count + 6);
-            fillTriangles.push_back(count + 6);
-            fillTriangles.push_back(count + 7);
-            fillTriangles.push_back(count + 4);
-        }
+        createSharpJoint(fill, circlex, circley, width, a);
+        createArm(fill, {}, width, length, m11, m12);
+        createArm(fill, {}, width, length, m21, m22);
         // endregion
     }
     else
@@ -345,111 +272,18 @@ static void createTileMesh(float width, float length, sf::Angle startAngle, sf::
         width += outline;
         length += outline;
 
-        const sf::Vector3f midpoint{-m11 * 0.04f, -m12 * 0.04f, 0};
-        createCircle(midpoint, width, outlineVertices, outlineTriangles, m_interpolationLevel);
-
-        {
-            const size_t count = outlineVertices.size();
-            outlineVertices.push_back(midpoint +
-                                      sf::Vector3f(length * m11 + width * m12, length * m12 - width * m11, 0));
-            outlineVertices.push_back(midpoint +
-                                      sf::Vector3f(length * m11 - width * m12, length * m12 + width * m11, 0));
-            outlineVertices.push_back(midpoint + sf::Vector3f(-width * m12, width * m11, 0));
-            outlineVertices.push_back(midpoint + sf::Vector3f(width * m12, -width * m11, 0));
-
-            outlineTriangles.push_back(count);
-            outlineTriangles.push_back(count + 1);
-            outlineTriangles.push_back(count + 2);
-            outlineTriangles.push_back(count + 2);
-            outlineTriangles.push_back(count + 3);
-            outlineTriangles.push_back(count);
-        }
+        const sf::Vector2f midpoint{-m11 * 0.04f, -m12 * 0.04f};
+        createCircle(border, midpoint, width, m_interpolationLevel);
+        createArm(border, midpoint, width, length, m11, m12);
         // endregion
         // region fill
         width -= outline * 2.f;
         length -= outline * 2.f;
-        createCircle(midpoint, width, fillVertices, fillTriangles, m_interpolationLevel);
-        {
-            const size_t count = fillVertices.size();
-            fillVertices.push_back(midpoint + sf::Vector3f(length * m11 + width * m12, length * m12 - width * m11, 0));
-            fillVertices.push_back(midpoint + sf::Vector3f(length * m11 - width * m12, length * m12 + width * m11, 0));
-            fillVertices.push_back(midpoint + sf::Vector3f(-width * m12, width * m11, 0));
-            fillVertices.push_back(midpoint + sf::Vector3f(width * m12, -width * m11, 0));
-
-            fillTriangles.push_back(count);
-            fillTriangles.push_back(count + 1);
-            fillTriangles.push_back(count + 2);
-            fillTriangles.push_back(count + 2);
-            fillTriangles.push_back(count + 3);
-            fillTriangles.push_back(count);
-        }
+        createCircle(fill, midpoint, width, m_interpolationLevel);
+        createArm(fill, midpoint, width, length, m11, m12);
         // endregion
     }
-
-    // using namespace bg = boost::geometry;
-    // using point_t = bg::model::point<double, 2, bg::cs::cartesian>;
-    // using polygon_t = bg::model::polygon<point_t>;
-    // using mpolygon_t = bg::model::multi_polygon<polygon_t>;
-    // mpolygon_t fillPolygon, outlinePolygon;
-    //
-    // for (size_t i = 0; i < fillVertices.size(); i += 3)
-    // {
-    //     const size_t idx1 = fillTriangles[i], idx2 = fillTriangles[i + 1], idx3 = fillTriangles[i + 2];
-    //     const sf::Vector3f v1 = fillVertices[idx1], v2 = fillVertices[idx2], v3 = fillVertices[idx3];
-    //     polygon_t polygon({{v1.x, v1.y},{v2.x, v2.y},{v3.x, v3.y}});
-    //     if (i != 0)
-    //     {
-    //         mpolygon_t tmp;
-    //         bg::union_(fillPolygon, polygon, tmp);
-    //         fillPolygon = tmp;
-    //     }
-    // }
-    // for (size_t i = 0; i < outlineVertices.size(); i += 3)
-    // {
-    //     const size_t idx1 = outlineTriangles[i], idx2 = outlineTriangles[i + 1], idx3 = outlineTriangles[i + 2];
-    //     const sf::Vector3f v1 = outlineVertices[idx1], v2 = outlineVertices[idx2], v3 = outlineVertices[idx3];
-    //     polygon_t polygon({{v1.x, v1.y},{v2.x, v2.y},{v3.x, v3.y}});
-    //     if (i != 0)
-    //     {
-    //         mpolygon_t tmp;
-    //         bg::union_(outlinePolygon, polygon, tmp);
-    //         outlinePolygon = tmp;
-    //     }
-    // }
-    // {
-    //     mpolygon_t tmp;
-    //     bg::difference(outlinePolygon, fillPolygon, tmp);
-    //     outlinePolygon = tmp;
-    // }
-    // {
-    //
-    // }
-    // using Coord = double;
-    //
-    // using N = uint32_t;
-    //
-    // using Point = std::array<Coord, 2>;
-    // std::vector<std::vector<Point>> polygon;
-    //
-    // // Fill polygon structure with actual data. Any winding order works.
-    // // The first polyline defines the main polygon.
-    // polygon.push_back({{100, 0}, {100, 100}, {0, 100}, {0, 0}});
-    // // Following polylines define holes.
-    // polygon.push_back({{75, 25}, {75, 75}, {25, 75}, {25, 25}});
-    //
-    // // Run tessellation
-    // // Returns array of indices that refer to the vertices of the input polygon.
-    // // e.g: the index 6 would refer to {25, 75} in this example.
-    // // Three subsequent indices form a triangle. Output triangles are clockwise.
-    // std::vector<N> indices = mapbox::earcut<N>(polygon);
-
-    m_fillVertices.clear(), m_outlineVertices.clear();
-    m_fillVertices.setPrimitiveType(sf::PrimitiveType::Triangles);
-    m_outlineVertices.setPrimitiveType(sf::PrimitiveType::Triangles);
-    for (const size_t idx : fillTriangles)
-        m_fillVertices.append(sf::Vertex(sf::Vector2f(fillVertices[idx].x, fillVertices[idx].y)));
-    for (const size_t idx : outlineTriangles)
-        m_outlineVertices.append(sf::Vertex(sf::Vector2f(outlineVertices[idx].x, outlineVertices[idx].y)));
+    fill.finish(), border.finish();
 }
 // Thanks for StArray's code
 // ReSharper disable once CppDFAConstantParameter
@@ -459,66 +293,56 @@ static void createMidSpinMesh(float width, sf::Angle a1, uint32_t m_interpolatio
     a1 = a1.wrapUnsigned();
     float length = width;
     const float m1 = std::cos(a1.asRadians()), m2 = std::sin(a1.asRadians());
+    const size_t capacity = tileMeshCapacity(m_interpolationLevel);
+    TriangleWriter fill(m_fillVertices, capacity), border(m_outlineVertices, capacity);
 
+    const sf::Vector2f midpoint{-m1 * 0.04f, -m2 * 0.04f};
+    const auto createMidSpin = [&](TriangleWriter& writer)
+    {
+        createArm(writer, midpoint, width, length, m1, m2);
+        writer.triangle(midpoint + sf::Vector2f(-width * m1, -width * m2),
+                        midpoint + sf::Vector2f(width * m2, -width * m1),
+                        midpoint + sf::Vector2f(-width * m2, width * m1));
+    };
     // region outline
-    std::vector<sf::Vector3f> fillVertices, outlineVertices;
-    std::vector<size_t> fillTriangles, outlineTriangles;
-    const sf::Vector3f midpoint{-m1 * 0.04f, -m2 * 0.04f, 0};
     width += outline;
     length += outline;
-    {
-        constexpr size_t count = 0;
-        outlineVertices.push_back(midpoint + sf::Vector3f(length * m1 + width * m2, length * m2 - width * m1, 0));
-        outlineVertices.push_back(midpoint + sf::Vector3f(length * m1 - width * m2, length * m2 + width * m1, 0));
-        outlineVertices.push_back(midpoint + sf::Vector3f(-width * m2, width * m1, 0));
-        outlineVertices.push_back(midpoint + sf::Vector3f(width * m2, -width * m1, 0));
-        outlineVertices.push_back(midpoint + sf::Vector3f(-width * m1, -width * m2, 0));
-        outlineVertices.push_back(midpoint + sf::Vector3f(width * m2, -width * m1, 0));
-        outlineVertices.push_back(midpoint + sf::Vector3f(-width * m2, width * m1, 0));
-        outlineTriangles.push_back(count);
-        outlineTriangles.push_back(count + 1);
-        outlineTriangles.push_back(count + 2);
-        outlineTriangles.push_back(count + 2);
-        outlineTriangles.push_back(count + 3);
-        outlineTriangles.push_back(count);
-        outlineTriangles.push_back(count + 4);
-        outlineTriangles.push_back(count + 5);
-        outlineTriangles.push_back(count + 6);
-    }
+    createMidSpin(border);
     // endregion
     // region fill
     width -= outline * 2;
     length -= outline * 2;
-    {
-        const size_t count = fillVertices.size();
-        fillVertices.push_back(midpoint + sf::Vector3f(length * m1 + width * m2, length * m2 - width * m1, 0));
-        fillVertices.push_back(midpoint + sf::Vector3f(length * m1 - width * m2, length * m2 + width * m1, 0));
-        fillVertices.push_back(midpoint + sf::Vector3f(-width * m2, width * m1, 0));
-        fillVertices.push_back(midpoint + sf::Vector3f(width * m2, -width * m1, 0));
-        fillVertices.push_back(midpoint + sf::Vector3f(-width * m1, -width * m2, 0));
-        fillVertices.push_back(midpoint + sf::Vector3f(width * m2, -width * m1, 0));
-        fillVertices.push_back(midpoint + sf::Vector3f(-width * m2, width * m1, 0));
-        fillTriangles.push_back(count);
-        fillTriangles.push_back(count + 1);
-        fillTriangles.push_back(count + 2);
-        fillTriangles.push_back(count + 2);
-        fillTriangles.push_back(count + 3);
-        fillTriangles.push_back(count);
-        fillTriangles.push_back(count + 4);
-        fillTriangles.push_back(count + 5);
-        fillTriangles.push_back(count + 6);
-    }
+    createMidSpin(fill);
     // endregion
-
-    m_fillVertices.clear(), m_outlineVertices.clear();
-    m_fillVertices.setPrimitiveType(sf::PrimitiveType::Triangles);
-    m_outlineVertices.setPrimitiveType(sf::PrimitiveType::Triangles);
-    for (const size_t idx : fillTriangles)
-        m_fillVertices.append(sf::Vertex(sf::Vector2f(fillVertices[idx].x, fillVertices[idx].y)));
-    for (const size_t idx : outlineTriangles)
-        m_outlineVertices.append(sf::Vertex(sf::Vector2f(outlineVertices[idx].x, outlineVertices[idx].y)));
+    fill.finish(), border.finish();
 }
 
+/**
+ * @brief The shader that tints the (white) tile meshes with a per-tile color.
+ *
+ * Tile colors change every frame for animated tracks, so they are passed as a uniform instead of being written into
+ * every vertex. Returns nullptr when shaders are unavailable; TileShape then colors the vertices itself.
+ */
+static sf::Shader* getTintShader()
+{
+    static const std::unique_ptr<sf::Shader> shader = []() -> std::unique_ptr<sf::Shader>
+    {
+        if (!sf::Shader::isAvailable())
+            return nullptr;
+        auto tintShader = std::make_unique<sf::Shader>();
+        if (!tintShader->loadFromMemory("uniform vec4 tint;"
+                                        "void main() { gl_FragColor = gl_Color * tint; }",
+                                        sf::Shader::Type::Fragment))
+            return nullptr;
+        return tintShader;
+    }();
+    return shader.get();
+}
+static void paintVertices(sf::VertexArray& vertices, const sf::Color color)
+{
+    for (size_t i = 0; i < vertices.getVertexCount(); i++)
+        vertices[i].color = color;
+}
 TileShape::TileShape(const double l_lastAngle, const double l_angle, const double l_nextAngle)
 {
     m_lastAngle = l_lastAngle, m_angle = l_angle, m_nextAngle = l_nextAngle;
@@ -537,6 +361,8 @@ void TileShape::update()
         createTileMesh(width, length, startAngle, endAngle, m_interpolationLevel, m_fillVertices, m_outlineVertices);
     }
     m_bounds = m_outlineVertices.getBounds();
+    if (!getTintShader())
+        paintVertices(m_fillVertices, m_fillColor), paintVertices(m_outlineVertices, m_outlineColor);
 }
 sf::FloatRect TileShape::getLocalBounds() const { return m_bounds; }
 sf::FloatRect TileShape::getGlobalBounds() const { return getTransform().transformRect(getLocalBounds()); }
@@ -557,22 +383,35 @@ void TileShape::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
     states.transform *= getTransform();
     states.texture = nullptr;
+    if (sf::Shader* shader = getTintShader())
+    {
+        states.shader = shader;
+        shader->setUniform("tint", sf::Glsl::Vec4(m_outlineColor));
+        target.draw(m_outlineVertices, states);
+        shader->setUniform("tint", sf::Glsl::Vec4(m_fillColor));
+        target.draw(m_fillVertices, states);
+        return;
+    }
     target.draw(m_outlineVertices, states);
     target.draw(m_fillVertices, states);
 }
 sf::Color TileShape::getFillColor() const { return m_fillColor; }
 void TileShape::setFillColor(const sf::Color color)
 {
+    if (m_fillColor == color)
+        return;
     m_fillColor = color;
-    for (size_t i = 0; i < m_fillVertices.getVertexCount(); i++)
-        m_fillVertices[i].color = m_fillColor;
+    if (!getTintShader())
+        paintVertices(m_fillVertices, m_fillColor);
 }
 sf::Color TileShape::getOutlineColor() const { return m_outlineColor; }
 void TileShape::setOutlineColor(const sf::Color color)
 {
+    if (m_outlineColor == color)
+        return;
     m_outlineColor = color;
-    for (size_t i = 0; i < m_outlineVertices.getVertexCount(); i++)
-        m_outlineVertices[i].color = m_outlineColor;
+    if (!getTintShader())
+        paintVertices(m_outlineVertices, m_outlineColor);
 }
 TileSprite::TileSprite(const double lastAngleDeg, const double angleDeg, const double nextAngleDeg)
 {
@@ -654,7 +493,7 @@ void TileSprite::draw(sf::RenderTarget& target, sf::RenderStates states) const
 void TileSystem::parse()
 {
     double lastAngle, nextAngle;
-    m_tileSprites.clear();
+    m_tileSprites.clear(), m_needFullUpdate = true;
     const auto& tiles = m_level.tiles;
     const auto& settings = m_level.settings;
     for (size_t i = 0; i < tiles.size(); i++)
@@ -695,26 +534,47 @@ void TileSystem::parse()
         }
     }
 }
-// ReSharper disable once CppMemberFunctionMayBeConst
 void TileSystem::update()
 {
-    auto& tiles = m_level.tiles;
-    for (size_t i = 0; i < m_tileSprites.size(); i++)
+    // Only the tiles the level reported as changed need new render state, plus the tiles whose
+    // active highlight toggled. After parse() every sprite is fresh and is updated once.
+    m_level.takeChangedTiles(m_changedTiles);
+    if (m_needFullUpdate)
     {
-        // ReSharper disable CppCStyleCast
-        auto& sprite = m_tileSprites[i];
-        const auto& tile = tiles[i];
-
-        sprite.setPosition({(float)tile.pos.c.x, (float)tile.pos.c.y});
-        sprite.setActive(m_activeTileIndex ? m_activeTileIndex == i : false);
-        // sprite.setTrackColor(sf::Color(tile.color.toInteger()));
-        // sprite.setTrackStyle(tile.trackStyle.c);
-        sprite.setScale({(float)tile.scale.c.x / 100, (float)tile.scale.c.y / 100});
-        sprite.setRotation(sf::degrees((float)tile.rotation.c));
-        // sprite.setOpacity((float)tile.opacity);
-        sprite.update();
-        // ReSharper restore CppCStyleCast
+        for (size_t i = 0; i < m_tileSprites.size(); i++)
+            updateSprite(i);
+        m_needFullUpdate = false;
+    }
+    else
+    {
+        for (const size_t i : m_changedTiles)
+            if (i < m_tileSprites.size())
+                updateSprite(i);
+        if (m_shownActiveTileIndex != m_activeTileIndex)
+        {
+            if (m_shownActiveTileIndex && *m_shownActiveTileIndex < m_tileSprites.size())
+                updateSprite(*m_shownActiveTileIndex);
+            if (m_activeTileIndex && *m_activeTileIndex < m_tileSprites.size())
+                updateSprite(*m_activeTileIndex);
+        }
     }
+    m_shownActiveTileIndex = m_activeTileIndex;
+}
+void TileSystem::updateSprite(const size_t i)
+{
+    // ReSharper disable CppCStyleCast
+    auto& sprite = m_tileSprites[i];
+    const auto& tile = m_level.tiles[i];
+
+    sprite.setPosition({(float)tile.pos.c.x, (float)tile.pos.c.y});
+    sprite.setActive(m_activeTileIndex ? m_activeTileIndex == i : false);
+    sprite.setTrackColor(sf::Color(tile.color.toInteger()));
+    sprite.setTrackStyle(tile.trackStyle.c);
+    sprite.setScale({(float)tile.scale.c.x / 100, (float)tile.scale.c.y / 100});
+    sprite.setRotation(sf::degrees((float)tile.rotation.c));
+    sprite.setOpacity((float)tile.opacity);
+    sprite.update();
+    // ReSharper restore CppCStyleCast
 }
 void TileSystem::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
@@ -730,18 +590,12 @@ void TileSystem::draw(sf::RenderTarget& target, sf::RenderStates states) const
             break;
         if (i == 0)
             reachZero = true;
-        auto& sprite = m_tileSprites[i];
+        const auto& sprite = m_tileSprites[i];
         const auto& tile = m_level.tiles[i];
 
         if (currentViewRect.findIntersection(sprite.getGlobalBoundsFaster()) && tile.scale.c.x != 0 &&
             tile.scale.c.y != 0)
-        {
-            sprite.setTrackColor(sf::Color(tile.color.toInteger()));
-            sprite.setTrackStyle(tile.trackStyle.c);
-            sprite.setOpacity(static_cast<float>(tile.opacity));
-            sprite.update();
-            target.draw(m_tileSprites[i]);
-        }
+            target.draw(sprite);
     }
     // ReSharper disable once CppDFAConstantConditions
     if (m_activeTileIndex && m_tilePlaceMode)
@@ -138,9 +138,13 @@ public:
 
 private:
     void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+    void updateSprite(size_t i);
     AdoCpp::Level& m_level;
     std::optional<size_t> m_activeTileIndex;
-    mutable std::vector<TileSprite> m_tileSprites;
+    std::optional<size_t> m_shownActiveTileIndex;
+    bool m_needFullUpdate{true};
+    std::vector<size_t> m_changedTiles; // reused for every AdoCpp::Level::takeChangedTiles
+    std::vector<TileSprite> m_tileSprites;
     int m_tilePlaceMode{};
     sf::Font font{"assets/font/Maplestory OTF Bold.otf"};
 };
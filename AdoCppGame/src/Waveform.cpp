@@ -0,0 +1,59 @@
+#include "Waveform.h"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+
+static WaveformPyramid::Range merge(const WaveformPyramid::Range a, const WaveformPyramid::Range b)
+{
+    return {std::min(a.min, b.min), std::max(a.max, b.max)};
+}
+
+WaveformPyramid::WaveformPyramid(const int16_t* samples, const uint64_t frameCount, const unsigned channelCount) :
+    m_samples(samples), m_frameCount(frameCount), m_channelCount(channelCount)
+{
+    std::vector<Range> level((frameCount + baseBinFrames - 1) / baseBinFrames, Range{INT16_MAX, INT16_MIN});
+    for (uint64_t bin = 0; bin < level.size(); bin++)
+    {
+        const uint64_t end = std::min(frameCount, (bin + 1) * baseBinFrames) * channelCount;
+        Range range = level[bin];
+        for (uint64_t i = bin * baseBinFrames * channelCount; i < end; i++)
+            range.min = std::min(range.min, samples[i]), range.max = std::max(range.max, samples[i]);
+        level[bin] = range;
+    }
+    m_levels.push_back(std::move(level));
+    while (m_levels.back().size() > 1)
+    {
+        const std::vector<Range>& finer = m_levels.back();
+        std::vector<Range> coarser((finer.size() + 1) / 2);
+        for (size_t bin = 0; bin < coarser.size(); bin++)
+            coarser[bin] = 2 * bin + 1 < finer.size() ? merge(finer[2 * bin], finer[2 * bin + 1]) : finer[2 * bin];
+        m_levels.push_back(std::move(coarser));
+    }
+    if (!m_levels.back().empty())
+    {
+        const Range all = m_levels.back().front();
+        m_peak = static_cast<int16_t>(std::clamp(std::max(std::abs(all.min), std::abs(all.max)), 1, INT16_MAX));
+    }
+}
+
+WaveformPyramid::Range WaveformPyramid::query(uint64_t begin, uint64_t end) const
+{
+    end = std::min(end, m_frameCount);
+    if (begin >= end)
+        return {0, 0};
+    Range range{INT16_MAX, INT16_MIN};
+    if (end - begin < 2 * baseBinFrames)
+    {
+        for (uint64_t i = begin * m_channelCount; i < end * m_channelCount; i++)
+            range.min = std::min(range.min, m_samples[i]), range.max = std::max(range.max, m_samples[i]);
+        return range;
+    }
+    // The coarsest level whose bins are at most half the range, so only a handful of bins are read.
+    const size_t levelIndex =
+        std::min<size_t>(m_levels.size() - 1, std::bit_width((end - begin) / (2 * baseBinFrames)) - 1);
+    const std::vector<Range>& level = m_levels[levelIndex];
+    const uint64_t binFrames = baseBinFrames << levelIndex;
+    for (uint64_t bin = begin / binFrames; bin <= (end - 1) / binFrames && bin < level.size(); bin++)
+        range = merge(range, level[bin]);
+    return range;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * A min/max summary of an int16 audio buffer at power-of-two resolutions.
+ *
+ * Level 0 summarises baseBinFrames frames per bin and every further level halves the bin count, so drawing a
+ * waveform at any zoom reads a few bins per pixel instead of every sample. The summary takes about a quarter of
+ * the memory of the samples themselves.
+ */
+class WaveformPyramid
+{
+public:
+    static constexpr uint64_t baseBinFrames = 16;
+
+    struct Range
+    {
+        int16_t min, max;
+    };
+
+    WaveformPyramid() = default;
+    /**
+     * Builds the summary. The samples must stay alive as long as the pyramid, because very short ranges are read
+     * from them directly.
+     */
+    WaveformPyramid(const int16_t* samples, uint64_t frameCount, unsigned channelCount);
+
+    /**
+     * The range of all channels over the frames [begin, end). Bins overlapping the edges are included whole, which
+     * is invisible at one pixel per query.
+     */
+    [[nodiscard]] Range query(uint64_t begin, uint64_t end) const;
+    /**
+     * The largest absolute sample value, at least 1, for normalising.
+     */
+    [[nodiscard]] int16_t getPeak() const { return m_peak; }
+    [[nodiscard]] uint64_t getFrameCount() const { return m_frameCount; }
+
+private:
+    const int16_t* m_samples{};
+    uint64_t m_frameCount{};
+    unsigned m_channelCount{};
+    int16_t m_peak = 1;
+    std::vector<std::vector<Range>> m_levels;
+};
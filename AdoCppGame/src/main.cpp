@@ -1,4 +1,7 @@
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
 #include "Game.h"
 
 #ifdef NDEBUG
@@ -6,21 +9,104 @@
 #pragma comment(linker, "/subsystem:\"Windows\" /entry:\"mainCRTStartup\"")
 #endif // NDEBUG
 
-int main()
+static void printUsage()
+{
+    std::cerr << "Usage: AdoCppGame [--headless <level> <output directory> [--size <width>x<height>] "
+                 "[--framerate <fps>] [--extension <.png|.jpg|.bmp|.tga>] [--no-render] [--trace <trace.json>]]\n";
+}
+
+/**
+ * Parses the command line of the headless mode.
+ * @return std::nullopt if the arguments do not ask for the headless mode.
+ */
+static std::optional<HeadlessOptions> parseHeadlessOptions(const int argc, char* argv[])
+{
+    if (argc < 2 || std::strcmp(argv[1], "--headless") != 0)
+        return std::nullopt;
+    if (argc < 4)
+        throw std::invalid_argument("--headless needs a level and an output directory");
+    HeadlessOptions options;
+    options.levelPath = argv[2], options.outputDir = argv[3];
+    for (int i = 4; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--no-render") == 0)
+        {
+            options.renderFrames = false;
+            continue;
+        }
+        if (i + 1 >= argc)
+            throw std::invalid_argument(std::string("missing value of ") + argv[i]);
+        if (const char* value = argv[++i]; std::strcmp(argv[i - 1], "--size") == 0)
+        {
+            unsigned width, height;
+            if (std::sscanf(value, "%ux%u", &width, &height) != 2 || width == 0 || height == 0)
+                throw std::invalid_argument(std::string("invalid size ") + value);
+            options.size = {width, height};
+        }
+        else if (std::strcmp(argv[i - 1], "--framerate") == 0)
+        {
+            options.framerate = static_cast<uint32_t>(std::stoul(value));
+            if (options.framerate == 0)
+                throw std::invalid_argument("the framerate must be positive");
+        }
+        else if (std::strcmp(argv[i - 1], "--extension") == 0)
+            options.extension = value;
+        else if (std::strcmp(argv[i - 1], "--trace") == 0)
+            options.tracePath = value;
+        else
+            throw std::invalid_argument(std::string("unknown option ") + argv[i - 1]);
+    }
+    return options;
+}
+
+/**
+ * @return The exit code: 2 for a bad command line, 1 if the headless mode failed.
+ */
+static int runGame(const int argc, char* argv[])
+{
+    std::optional<HeadlessOptions> headlessOptions;
+    try
+    {
+        headlessOptions = parseHeadlessOptions(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        printUsage();
+        return 2;
+    }
+    if (headlessOptions)
+    {
+        // Build servers only see the exit code, so every failure is caught here, in debug builds as well.
+        try
+        {
+            Game game(*headlessOptions);
+            return game.runHeadless() ? 0 : 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    Game game;
+    game.run();
+    return 0;
+}
+
+int main(const int argc, char* argv[])
 {
 #ifdef NDEBUG
     try
     {
-        Game game;
-        game.run();
+        return runGame(argc, argv);
     }
     catch (const std::exception& e)
     {
         std::cerr << "Fatal Error: " << e.what() << std::endl;
+        return 1;
     }
 #else
-    Game game;
-    game.run();
+    return runGame(argc, argv);
 #endif
-    return 0;
 }
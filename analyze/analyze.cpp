@@ -0,0 +1,261 @@
+/**
+ * @file analyze.cpp
+ * @brief Loads and parses ADOFAI levels and prints their metrics, one JSON object per line.
+ *
+ * Usage: adocpp-analyze [--jobs N] [--update-steps N] <level or directory>...
+ *
+ * Directories are searched recursively for .adofai files. The levels are analysed by a pool of N worker threads
+ * (the number of hardware threads by default), each holding one level at a time, and every line is written as soon
+ * as its level is done, so the order of the lines is not the order of the inputs. A level that fails to load gets
+ * a line with its path and an "error". A summary goes to stderr.
+ */
+#include <AdoCpp.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct AnalyzeConfig
+{
+    std::vector<std::filesystem::path> inputs;
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    size_t updateSteps = 100;
+};
+
+static double msSince(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::vector<std::filesystem::path> collectLevels(const std::vector<std::filesystem::path>& inputs)
+{
+    const auto isLevel = [](const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().string();
+        std::ranges::transform(extension, extension.begin(), [](const unsigned char c) { return std::tolower(c); });
+        return extension == ".adofai";
+    };
+    std::vector<std::filesystem::path> levels;
+    for (const auto& input : inputs)
+    {
+        if (!std::filesystem::is_directory(input))
+        {
+            levels.push_back(input);
+            continue;
+        }
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(
+                 input, std::filesystem::directory_options::skip_permission_denied))
+            if (entry.is_regular_file() && isLevel(entry.path()))
+                levels.push_back(entry.path());
+    }
+    return levels;
+}
+
+/**
+ * The time spent at each bpm between the first and the last hit, from the level's speed data.
+ */
+static Json::Value bpmMetrics(const AdoCpp::Level& level)
+{
+    const auto& speedData = level.getSpeedData();
+    const double begin = level.tiles[1].seconds, end = level.tiles.back().seconds;
+    std::map<double, double> secondsByBpm;
+    for (size_t i = 0; i < speedData.size(); i++)
+    {
+        const double from = std::max(begin, speedData[i].seconds),
+                     to = std::min(end, i + 1 < speedData.size() ? speedData[i + 1].seconds : end);
+        if (to > from)
+            secondsByBpm[std::round(speedData[i].bpm * 100) / 100] += to - from;
+    }
+    if (secondsByBpm.empty())
+        secondsByBpm[level.getBpmBySeconds(begin)] = 0;
+
+    Json::Value val(Json::objectValue);
+    double total = 0, weighted = 0;
+    Json::Value& distribution = val["distribution"] = Json::Value(Json::arrayValue);
+    for (const auto& [bpm, seconds] : secondsByBpm)
+    {
+        total += seconds, weighted += bpm * seconds;
+        Json::Value pair(Json::arrayValue);
+        pair.append(bpm), pair.append(seconds);
+        distribution.append(pair);
+    }
+    double median = secondsByBpm.begin()->first, accumulated = 0;
+    for (const auto& [bpm, seconds] : secondsByBpm)
+        if (accumulated += seconds; accumulated >= total / 2)
+        {
+            median = bpm;
+            break;
+        }
+    val["changes"] = Json::UInt64(speedData.size() - 1);
+    val["min"] = secondsByBpm.begin()->first, val["max"] = secondsByBpm.rbegin()->first;
+    val["mean"] = total > 0 ? weighted / total : secondsByBpm.begin()->first, val["median"] = median;
+    return val;
+}
+
+/**
+ * Keys per second of every hit from the angle and the bpm before it, as shown while playing, and the densest
+ * second of the level.
+ */
+static Json::Value kpsMetrics(const AdoCpp::Level& level)
+{
+    const auto& tiles = level.tiles;
+    std::vector<double> kps, hits;
+    double maxKps = 0;
+    size_t maxFloor = 0;
+    for (size_t i = 1; i < tiles.size(); i++)
+    {
+        if (tiles[i].angle.deg() == 999)
+            continue;
+        hits.push_back(tiles[i].seconds);
+        // The first hit has no hit before it.
+        if (const double degrees = level.getAngle(i).deg(); i >= 2 && degrees > 0)
+        {
+            kps.push_back(level.getBpmByBeat(tiles[i - 1].beat) / 60 / (degrees / 180));
+            if (kps.back() > maxKps)
+                maxKps = kps.back(), maxFloor = i;
+        }
+    }
+    size_t peak = 0;
+    for (size_t first = 0, last = 0; last < hits.size(); last++)
+    {
+        while (hits[last] - hits[first] >= 1)
+            first++;
+        peak = std::max(peak, last - first + 1);
+    }
+
+    Json::Value val(Json::objectValue);
+    val["max"] = maxKps, val["maxFloor"] = Json::UInt64(maxFloor);
+    if (!kps.empty())
+    {
+        const auto p95 = kps.begin() + static_cast<std::ptrdiff_t>(kps.size() * 95 / 100);
+        std::ranges::nth_element(kps, p95);
+        val["p95"] = *p95;
+    }
+    else
+        val["p95"] = 0;
+    const double span = hits.empty() ? 0 : hits.back() - hits.front();
+    val["mean"] = span > 0 ? static_cast<double>(hits.size() - 1) / span : 0;
+    val["peakHitsIn1s"] = Json::UInt64(peak);
+    return val;
+}
+
+static Json::Value analyzeLevel(const std::filesystem::path& path, const AnalyzeConfig& config)
+{
+    Json::Value val(Json::objectValue);
+    val["path"] = path.string();
+
+    auto start = std::chrono::steady_clock::now();
+    AdoCpp::Level level;
+    level.fromFile(path);
+    const double loadMs = msSince(start);
+    if (level.tiles.size() < 2)
+        throw std::runtime_error("The level has fewer than two tiles");
+    start = std::chrono::steady_clock::now();
+    level.parse();
+    const double parseMs = msSince(start);
+    const double duration = level.tiles.back().seconds;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < config.updateSteps; i++)
+        level.update(duration * static_cast<double>(i) / static_cast<double>(config.updateSteps));
+    const double updateMs = msSince(start);
+
+    val["tiles"] = Json::UInt64(level.tiles.size());
+    val["firstHitSeconds"] = level.tiles[1].seconds, val["durationSeconds"] = duration;
+    val["bpm"] = bpmMetrics(level);
+    val["kps"] = kpsMetrics(level);
+
+    std::map<std::string, size_t> counts;
+    size_t total = 0;
+    for (const auto& tile : level.tiles)
+        for (const auto& event : tile.events)
+            counts[event->name()]++, total++;
+    Json::Value& events = val["events"] = Json::Value(Json::objectValue);
+    for (const auto& [name, count] : counts)
+        events[name] = Json::UInt64(count);
+    events["total"] = Json::UInt64(total);
+
+    Json::Value& timings = val["timings"];
+    timings["loadMs"] = loadMs, timings["parseMs"] = parseMs;
+    timings["updateMs"] = updateMs, timings["updateSteps"] = Json::UInt64(config.updateSteps);
+    if constexpr (AdoCpp::ParseStats::enabled)
+        val["parseStats"] = level.parseStats().intoJson();
+    return val;
+}
+
+int main(const int argc, char* argv[])
+{
+    AnalyzeConfig config;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--jobs" || arg == "--update-steps")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return 1;
+            }
+            const char* value = argv[++i];
+            if (arg == "--jobs")
+                config.jobs = std::max(1u, static_cast<unsigned>(std::stoul(value)));
+            else
+                config.updateSteps = std::stoull(value);
+        }
+        else if (arg.starts_with("--"))
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+        else
+            config.inputs.emplace_back(arg);
+    }
+    if (config.inputs.empty())
+    {
+        std::cerr << "Usage: adocpp-analyze [--jobs N] [--update-steps N] <level or directory>..." << std::endl;
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<std::filesystem::path> levels = collectLevels(config.inputs);
+    std::atomic<size_t> next = 0, failed = 0;
+    std::mutex outputMutex;
+    const auto work = [&]
+    {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "", builder["emitUTF8"] = true, builder["precision"] = 9;
+        for (size_t i; (i = next.fetch_add(1)) < levels.size();)
+        {
+            Json::Value val;
+            try
+            {
+                val = analyzeLevel(levels[i], config);
+            }
+            catch (const std::exception& e)
+            {
+                val = Json::Value(Json::objectValue);
+                val["path"] = levels[i].string(), val["error"] = e.what();
+                failed++;
+            }
+            const std::string line = Json::writeString(builder, val);
+            std::scoped_lock lock(outputMutex);
+            std::cout << line << '\n' << std::flush;
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < std::min<size_t>(config.jobs, levels.size()); i++)
+        workers.emplace_back(work);
+    for (auto& worker : workers)
+        worker.join();
+
+    std::cerr << "Analysed " << levels.size() << " levels (" << failed << " failed) in " << msSince(start) / 1000
+              << " s with " << workers.size() << " workers" << std::endl;
+    return failed == 0 ? 0 : 2;
+}
@@ -0,0 +1,254 @@
+/**
+ * @file bench.cpp
+ * @brief Times the hot paths of the AdoCpp library on synthetic levels.
+ *
+ * Usage: AdoCppBench [--tiles N] [--seed S] [--path PATTERN] [--midspins D] [--set-speed D]
+ *                    [--max-speed-factor F] [--twirls D] [--move-track D] [--recolor-track D] [--move-camera D]
+ *                    [--repeat-events D] [--repeat-depth N] [--iterations K] [--update-steps N] [--queries N]
+ *                    [--format json|csv] [--output PATH]
+ *
+ * The level comes from AdoCpp::LevelGenerator; see GeneratorOptions for what the options mean. A density D is
+ * the chance of a tile getting an event of that type. The results go to stdout unless --output is given.
+ */
+#include <AdoCpp.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * The level of a run without options. Assigned field by field, so new options keep their defaults.
+ */
+static AdoCpp::GeneratorOptions defaultLevelOptions()
+{
+    AdoCpp::GeneratorOptions options;
+    options.tileCount = 10000, options.seed = 1;
+    return options;
+}
+
+struct BenchConfig
+{
+    AdoCpp::GeneratorOptions level = defaultLevelOptions();
+    size_t iterations = 5;
+    size_t updateSteps = 1000;
+    size_t queries = 100000;
+    std::string format = "json";
+    std::filesystem::path output;
+};
+
+struct BenchResult
+{
+    std::string name;
+    size_t iterations;
+    double minMs, medianMs, meanMs;
+};
+
+/**
+ * Runs setup then body config.iterations times and keeps the time of body only.
+ */
+static BenchResult measure(const std::string& name, const size_t iterations, const std::function<void()>& setup,
+                           const std::function<void()>& body)
+{
+    std::vector<double> times;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        setup();
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::ranges::sort(times);
+    return {name, iterations, times.front(), times[times.size() / 2],
+            std::accumulate(times.begin(), times.end(), 0.0) / static_cast<double>(times.size())};
+}
+
+static std::vector<BenchResult> runBenchmarks(const BenchConfig& config)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "AdoCppBench.adofai";
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        AdoCpp::LevelGenerator(config.level).write(ofs);
+    }
+    const size_t n = config.iterations;
+    const auto nothing = [] {};
+    std::vector<BenchResult> results;
+    volatile double sink = 0; // Keeps the queries from being optimised away.
+
+    AdoCpp::Level level;
+    results.push_back(measure("fromFile", n, nothing, [&] { level.fromFile(path); }));
+    results.push_back(measure("parse", n, [&] { level.fromFile(path); }, [&] { level.parse(); }));
+    if constexpr (AdoCpp::ParseStats::enabled)
+    {
+        const AdoCpp::ParseStats& stats = level.parseStats();
+        for (const auto& [name, ms] : {std::pair{"parse/parseTiles", stats.parseTilesMs},
+                                       {"parse/parseSetSpeed", stats.parseSetSpeedMs},
+                                       {"parse/parsePlanetOrbits", stats.parsePlanetOrbitsMs},
+                                       {"parse/parseDynamicEvents", stats.parseDynamicEventsMs},
+                                       {"parse/parseAnimateTrack", stats.parseAnimateTrackMs},
+                                       {"parse/parseRepeatEvents", stats.parseRepeatEventsMs},
+                                       {"parse/sortEvents", stats.sortEventsMs},
+                                       {"parse/parseMoveTrackData", stats.parseMoveTrackDataMs}})
+            results.push_back({name, 1, ms, ms, ms}); // The last iteration only.
+    }
+    const double duration = level.tiles.back().seconds;
+
+    results.push_back(measure("update", n, nothing,
+                              [&]
+                              {
+                                  for (size_t i = 0; i < config.updateSteps; i++)
+                                      level.update(duration * static_cast<double>(i) / config.updateSteps);
+                              }));
+    results.push_back(measure("intoJson", n, nothing, [&] { sink = level.intoJson()["actions"].size(); }));
+
+    AdoCpp::Camera camera;
+    results.push_back(measure("Camera::init", n, nothing, [&] { camera.init(level); }));
+    results.push_back(measure("Camera::update", n, [&] { camera.init(level); },
+                              [&]
+                              {
+                                  for (size_t i = 0; i < config.updateSteps; i++)
+                                  {
+                                      const double seconds = duration * static_cast<double>(i) / config.updateSteps;
+                                      camera.update(level, seconds, level.getFloorBySeconds(seconds));
+                                  }
+                                  sink = camera.position.x;
+                              }));
+
+    std::mt19937_64 rng(config.level.seed);
+    std::uniform_real_distribution time(0.0, duration);
+    std::vector<double> seconds(config.queries), beats(config.queries);
+    for (size_t i = 0; i < config.queries; i++)
+        seconds[i] = time(rng), beats[i] = level.seconds2beat(seconds[i]);
+    const auto query = [&](const char* name, const std::vector<double>& input, const auto& function)
+    {
+        results.push_back(measure(name, n, nothing,
+                                  [&]
+                                  {
+                                      double sum = 0;
+                                      for (const double x : input)
+                                          sum += static_cast<double>(function(x));
+                                      sink = sum;
+                                  }));
+    };
+    query("getFloorBySeconds", seconds, [&](const double x) { return level.getFloorBySeconds(x); });
+    query("getFloorByBeat", beats, [&](const double x) { return level.getFloorByBeat(x); });
+    // Playback: the queries move forward a little at a time, and each one starts from the last result.
+    std::vector<double> playback(config.queries);
+    for (size_t i = 0; i < config.queries; i++)
+        playback[i] = duration * static_cast<double>(i) / static_cast<double>(config.queries);
+    size_t hint = 0;
+    query("getFloorBySeconds/playback", playback, [&](const double x) { return level.getFloorBySeconds(x); });
+    query("getFloorBySeconds/playback/hint", playback,
+          [&](const double x) { return hint = level.getFloorBySeconds(x, hint); });
+    hint = 0;
+    query("getPlanetsPos/playback", playback,
+          [&](const double x) { return level.getPlanetsPos(hint = level.getFloorBySeconds(x, hint), x).first.x; });
+    results.push_back(measure("samplePlanetsPos", n, nothing,
+                              [&] { sink = level.samplePlanetsPos(0, duration, config.queries).back().first.x; }));
+    query("seconds2beat", seconds, [&](const double x) { return level.seconds2beat(x); });
+    query("beat2seconds", beats, [&](const double x) { return level.beat2seconds(x); });
+
+    std::filesystem::remove(path);
+    return results;
+}
+
+static void writeResults(std::ostream& os, const BenchConfig& config, const std::vector<BenchResult>& results)
+{
+    if (config.format == "csv")
+    {
+        os << "name,iterations,min_ms,median_ms,mean_ms\n";
+        for (const auto& [name, iterations, minMs, medianMs, meanMs] : results)
+            os << name << ',' << iterations << ',' << minMs << ',' << medianMs << ',' << meanMs << '\n';
+        return;
+    }
+    Json::Value doc(Json::objectValue);
+    doc["version"] = ADOCPP_VERSION;
+    Json::Value& level = doc["level"];
+    const AdoCpp::GeneratorOptions& options = config.level;
+    level["tiles"] = Json::UInt64(options.tileCount), level["seed"] = Json::UInt64(options.seed);
+    level["path"] = options.pathPattern, level["midspins"] = options.midspinDensity;
+    level["setSpeed"] = options.setSpeedDensity, level["maxSpeedFactor"] = options.maxSpeedFactor;
+    level["twirls"] = options.twirlDensity, level["moveTrack"] = options.moveTrackDensity;
+    level["recolorTrack"] = options.recolorTrackDensity, level["moveCamera"] = options.moveCameraDensity;
+    level["repeatEvents"] = options.repeatEventsDensity, level["repeatDepth"] = Json::UInt64(options.repeatEventsDepth);
+    doc["updateSteps"] = Json::UInt64(config.updateSteps), doc["queries"] = Json::UInt64(config.queries);
+    Json::Value& array = doc["results"] = Json::Value(Json::arrayValue);
+    for (const auto& [name, iterations, minMs, medianMs, meanMs] : results)
+    {
+        Json::Value val(Json::objectValue);
+        val["name"] = name, val["iterations"] = Json::UInt64(iterations);
+        val["min_ms"] = minMs, val["median_ms"] = medianMs, val["mean_ms"] = meanMs;
+        array.append(val);
+    }
+    Json::StreamWriterBuilder builder;
+    os << Json::writeString(builder, doc) << std::endl;
+}
+
+int main(const int argc, char* argv[])
+{
+    BenchConfig config;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 1;
+        }
+        const char* value = argv[++i];
+        AdoCpp::GeneratorOptions& level = config.level;
+        if (arg == "--tiles")
+            level.tileCount = std::max<size_t>(2, std::stoull(value));
+        else if (arg == "--seed")
+            level.seed = std::stoull(value);
+        else if (arg == "--path")
+            level.pathPattern = value;
+        else if (arg == "--midspins")
+            level.midspinDensity = std::stod(value);
+        else if (arg == "--set-speed")
+            level.setSpeedDensity = std::stod(value);
+        else if (arg == "--max-speed-factor")
+            level.maxSpeedFactor = std::stod(value);
+        else if (arg == "--twirls")
+            level.twirlDensity = std::stod(value);
+        else if (arg == "--move-track")
+            level.moveTrackDensity = std::stod(value);
+        else if (arg == "--recolor-track")
+            level.recolorTrackDensity = std::stod(value);
+        else if (arg == "--move-camera")
+            level.moveCameraDensity = std::stod(value);
+        else if (arg == "--repeat-events")
+            level.repeatEventsDensity = std::stod(value);
+        else if (arg == "--repeat-depth")
+            level.repeatEventsDepth = std::stoull(value);
+        else if (arg == "--iterations")
+            config.iterations = std::max<size_t>(1, std::stoull(value));
+        else if (arg == "--update-steps")
+            config.updateSteps = std::max<size_t>(1, std::stoull(value));
+        else if (arg == "--queries")
+            config.queries = std::max<size_t>(1, std::stoull(value));
+        else if (arg == "--format")
+            config.format = value;
+        else if (arg == "--output")
+            config.output = value;
+        else
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    const std::vector<BenchResult> results = runBenchmarks(config);
+    if (config.output.empty())
+        writeResults(std::cout, config, results);
+    else
+    {
+        std::ofstream ofs(config.output);
+        writeResults(ofs, config, results);
+    }
+    return 0;
+}
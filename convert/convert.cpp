@@ -0,0 +1,309 @@
+/**
+ * @file convert.cpp
+ * @brief Converts ADOFAI levels between compact JSON, pretty JSON5 and the binary cache, and between pathData and
+ * angleData.
+ *
+ * Usage: adocpp-convert [--jobs N] [--format json|json5|binary] [--path-data|--angle-data] [--validate]
+ *                       <input> <output>
+ *
+ * The input is a level (of any of the formats) or a directory, which is searched recursively for .adofai files and
+ * mirrored into the output directory with the same relative paths and file names. "-" reads the level from stdin
+ * or writes it to stdout. The files are converted by a pool of N worker threads (the number of hardware threads by
+ * default), each streaming one level from its file into a json value and from the value into its output file.
+ *
+ * Only the tiles are rewritten, so the events, the decorations and any unknown fields are kept as they are. A level
+ * with an angle that has no path letter keeps its angleData with --path-data. --validate also imports and parses
+ * every level and fails the files that the library cannot play. A summary with the throughput goes to stderr.
+ */
+#include <AdoCpp.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class Format
+{
+    Json,
+    Json5,
+    Binary
+};
+
+enum class TileData
+{
+    Keep,
+    PathData,
+    AngleData
+};
+
+struct ConvertConfig
+{
+    std::filesystem::path input, output;
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    Format format = Format::Json;
+    TileData tileData = TileData::Keep;
+    bool validate = false;
+};
+
+struct Job
+{
+    std::filesystem::path input, output;
+};
+
+struct ConvertResult
+{
+    uintmax_t inputBytes = 0, outputBytes = 0;
+    bool keptAngleData = false;
+};
+
+static double msSince(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::vector<Job> collectJobs(const ConvertConfig& config)
+{
+    const auto isLevel = [](const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().string();
+        std::ranges::transform(extension, extension.begin(), [](const unsigned char c) { return std::tolower(c); });
+        return extension == ".adofai";
+    };
+    if (config.input == "-" || !std::filesystem::is_directory(config.input))
+    {
+        if (config.output != "-" && std::filesystem::is_directory(config.output))
+            return {{config.input, config.output / config.input.filename()}};
+        return {{config.input, config.output}};
+    }
+    std::vector<Job> jobs;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(
+             config.input, std::filesystem::directory_options::skip_permission_denied))
+        if (entry.is_regular_file() && isLevel(entry.path()))
+            jobs.push_back({entry.path(), config.output / std::filesystem::relative(entry.path(), config.input)});
+    return jobs;
+}
+
+/**
+ * Rewrites the tiles of the level as pathData or angleData. Returns false if the angles have no path letters.
+ */
+static bool rewriteTiles(Json::Value& value, const TileData tileData)
+{
+    if (tileData == TileData::AngleData && value.isMember("pathData"))
+    {
+        Json::Value angleData(Json::arrayValue);
+        for (const char path : std::string(value["pathData"].asString()))
+            angleData.append(static_cast<Json::Int>(AdoCpp::path2angle(path)));
+        value.removeMember("pathData");
+        value["angleData"] = std::move(angleData);
+    }
+    else if (tileData == TileData::PathData && value.isMember("angleData"))
+    {
+        std::string pathData;
+        pathData.reserve(value["angleData"].size());
+        try
+        {
+            for (const auto& angle : value["angleData"])
+                pathData.push_back(AdoCpp::angle2path(angle.asDouble()));
+        }
+        catch (const std::invalid_argument&)
+        {
+            return false;
+        }
+        value.removeMember("angleData");
+        value["pathData"] = std::move(pathData);
+    }
+    return true;
+}
+
+static void validateLevel(const Json::Value& value)
+{
+    if (!value.isObject() || !(value.isMember("angleData") || value.isMember("pathData")))
+        throw std::runtime_error("The json has neither 'angleData' nor 'pathData'");
+    AdoCpp::Level level;
+    level.fromJson(value);
+    if (level.tiles.size() < 2)
+        throw std::runtime_error("The level has fewer than two tiles");
+    level.parse();
+    if (!std::isfinite(level.tiles.back().seconds))
+        throw std::runtime_error("The timing of the level is not finite");
+}
+
+static void readLevel(std::istream& is, Json::Value& value)
+{
+    std::string err;
+    const bool binary = AdoCpp::BinaryJson::detect(is);
+    if (!(binary ? AdoCpp::BinaryJson::read(is, value, &err) : Json5::parse(is, value, &err)))
+        throw std::runtime_error(err);
+}
+
+static void writeLevel(std::ostream& os, const Json::Value& value, const Format format,
+                       Json::StreamWriter& jsonWriter)
+{
+    switch (format)
+    {
+    case Format::Json:
+        jsonWriter.write(value, &os);
+        break;
+    case Format::Json5:
+        Json5::serialize(os, value, {.trailingCommas = false, .bareKeys = true, .indent = "\t"});
+        break;
+    case Format::Binary:
+        AdoCpp::BinaryJson::write(os, value);
+        break;
+    }
+}
+
+static ConvertResult convertLevel(const Job& job, const ConvertConfig& config, Json::StreamWriter& jsonWriter)
+{
+    ConvertResult result;
+    Json::Value value;
+    if (job.input == "-")
+    {
+        // Buffered, to count the bytes of a pipe.
+        std::ostringstream oss;
+        oss << std::cin.rdbuf();
+        const std::string data = std::move(oss).str();
+        result.inputBytes = data.size();
+        std::istringstream iss(data);
+        readLevel(iss, value);
+    }
+    else
+    {
+        std::ifstream ifs(job.input, std::ios::binary);
+        if (!ifs.is_open())
+            throw std::runtime_error("Could not open the file");
+        readLevel(ifs, value);
+        result.inputBytes = std::filesystem::file_size(job.input);
+    }
+
+    result.keptAngleData = !rewriteTiles(value, config.tileData);
+    if (config.validate)
+        validateLevel(value);
+
+    if (job.output == "-")
+    {
+        std::ostringstream oss;
+        writeLevel(oss, value, config.format, jsonWriter);
+        const std::string data = std::move(oss).str();
+        result.outputBytes = data.size();
+        std::cout.write(data.data(), static_cast<std::streamsize>(data.size())).flush();
+    }
+    else
+    {
+        std::ofstream ofs(job.output, std::ios::binary);
+        if (!ofs.is_open())
+            throw std::runtime_error("Could not create " + job.output.string());
+        writeLevel(ofs, value, config.format, jsonWriter);
+        if (!ofs.flush())
+            throw std::runtime_error("Could not write " + job.output.string());
+        result.outputBytes = static_cast<uintmax_t>(ofs.tellp());
+    }
+    return result;
+}
+
+int main(const int argc, char* argv[])
+{
+    ConvertConfig config;
+    std::vector<std::filesystem::path> paths;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--jobs" || arg == "--format")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--jobs")
+                config.jobs = std::max(1u, static_cast<unsigned>(std::stoul(value)));
+            else if (value == "json" || value == "json5" || value == "binary")
+                config.format = value == "json" ? Format::Json : value == "json5" ? Format::Json5 : Format::Binary;
+            else
+            {
+                std::cerr << "Unknown format " << value << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--path-data")
+            config.tileData = TileData::PathData;
+        else if (arg == "--angle-data")
+            config.tileData = TileData::AngleData;
+        else if (arg == "--validate")
+            config.validate = true;
+        else if (arg.starts_with("--"))
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+        else
+            paths.emplace_back(arg);
+    }
+    if (paths.size() != 2)
+    {
+        std::cerr << "Usage: adocpp-convert [--jobs N] [--format json|json5|binary] [--path-data|--angle-data] "
+                     "[--validate] <input> <output>"
+                  << std::endl;
+        return 1;
+    }
+    config.input = paths[0], config.output = paths[1];
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<Job> jobs = collectJobs(config);
+    // Created up front, so that the workers never race to create the same directory.
+    for (const Job& job : jobs)
+        if (job.output != "-" && job.output.has_parent_path())
+            std::filesystem::create_directories(job.output.parent_path());
+
+    std::atomic<size_t> next = 0, failed = 0, keptAngleData = 0;
+    std::atomic<uintmax_t> inputBytes = 0, outputBytes = 0;
+    std::mutex errorMutex;
+    const auto work = [&]
+    {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "", builder["emitUTF8"] = true;
+        const std::unique_ptr<Json::StreamWriter> jsonWriter(builder.newStreamWriter());
+        for (size_t i; (i = next.fetch_add(1)) < jobs.size();)
+        {
+            try
+            {
+                const ConvertResult result = convertLevel(jobs[i], config, *jsonWriter);
+                inputBytes += result.inputBytes, outputBytes += result.outputBytes;
+                if (result.keptAngleData)
+                    keptAngleData++;
+            }
+            catch (const std::exception& e)
+            {
+                failed++;
+                std::scoped_lock lock(errorMutex);
+                std::cerr << jobs[i].input.string() << ": " << e.what() << std::endl;
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < std::min<size_t>(config.jobs, jobs.size()); i++)
+        workers.emplace_back(work);
+    for (auto& worker : workers)
+        worker.join();
+
+    const double seconds = msSince(start) / 1000;
+    const double rate = seconds > 0 ? 1 / seconds : 0;
+    std::cerr << "Converted " << jobs.size() - failed << " of " << jobs.size() << " levels in " << seconds
+              << " s with " << workers.size() << " workers: " << static_cast<double>(jobs.size()) * rate
+              << " files/s, " << static_cast<double>(inputBytes) / 1e6 * rate << " MB/s in, "
+              << static_cast<double>(outputBytes) / 1e6 * rate << " MB/s out" << std::endl;
+    if (keptAngleData > 0)
+        std::cerr << keptAngleData << " levels kept their angleData, which has angles without path letters"
+                  << std::endl;
+    return failed == 0 ? 0 : 2;
+}